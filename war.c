@@ -9,460 +9,6943 @@
  * - Verificação automática de condições de vitória
  * - Gerenciamento completo de memória dinâmica
  * - Modularização avançada com ponteiros
+ * - Simulação de batalhas em massa, sem saída, usando todos os núcleos
+ * - Gerador aleatório próprio (xoshiro256**) com sementes reprodutíveis
+ * - Cores internadas como IDs e mapa armazenado em colunas (estrutura de arrays)
+ * - Agregados por cor atualizados a cada jogada (verificação de vitória em O(1))
+ * - Missões tipadas com parâmetros, verificadas por tabela de funções
+ * - Modo em lote: partidas roteirizadas lidas de arquivo ou stdin, sem prompts
+ * - Snapshots binários versionados, carregados com mmap, para salvar e retomar
+ * - Grafo de fronteiras em formato CSR, usado na validação de ataques e missões
+ * - Exibição do mapa bufferizada, paginada e com filtros
+ * - Gerador de partidas sintéticas e benchmarks com saída em JSON
+ * - Cálculo exato das chances de ataque (tabelas de dados + cadeia de Markov)
+ * - Ataque relâmpago (blitz): rodadas até a conquista com dados sorteados em bloco
+ * - Log binário de eventos com rotação e leitor em fluxo para análises (--analisar-log)
+ * - Torneios de partidas automáticas em paralelo (filas com roubo de trabalho)
+ * - Turnos simultâneos: ordens de todos os jogadores resolvidas em paralelo por fatias do mapa
+ * - Partida inteira em uma arena contígua: reinício por ponteiro e clonagem com memcpy
+ * - Diário de alterações do mapa para desfazer e refazer ataques
+ * - Auditoria de vitória pelas colunas e pelo grafo, sem agregados (escalar, SSE2 ou AVX2)
+ * - Autoverificação (--verificar): varreduras, chances, diário, snapshot e turnos simultâneos
+ * - Métricas por thread (contadores e histogramas) exportadas em JSON ou Prometheus
+ * - Servidor de muitas partidas simultâneas em um socket Unix (epoll)
+ * - Índice de nomes com hash (endereçamento aberto): nomes únicos e ataques por nome
  */
 
+#define _GNU_SOURCE // fopencookie e accept4 (modo servidor)
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <stdint.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+// Núcleos vetoriais da varredura de colunas (SSE2 é o mínimo em x86-64;
+// AVX2 é escolhido em tempo de execução quando o processador suporta)
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define VARREDURA_X86 1
+#endif
+
+// Limite de cores distintas em um jogo (IDs cabem em um byte)
+#define MAX_CORES 32
+
+// Parâmetros acompanhados pelos agregados do mapa; missões com outros
+// valores continuam válidas, mas são verificadas varrendo as colunas
+#define LIMITE_TROPAS_MISSAO 15
+#define TAMANHO_SEQUENCIA_MISSAO 3
 
-// Definição da struct Territorio para armazenar informações dos territórios
+// Definição da struct Territorio: registro usado no cadastro e na simulação.
+// O mapa do jogo não guarda estes registros, e sim colunas (veja Mapa).
 typedef struct {
     char nome[30];      // Nome do território (máximo 29 caracteres + \0)
     char cor[10];       // Cor do exército (máximo 9 caracteres + \0)
     int tropas;         // Quantidade de tropas no território
 } Territorio;
 
+// Registro de cores: cada nome de cor recebe um ID pequeno no cadastro.
+// A comparação de nomes ignora maiúsculas ("Vermelho" e "vermelho" são a mesma cor).
+typedef struct {
+    char nomes[MAX_CORES][10];
+    int total;
+} RegistroCores;
+
+// Totais por cor mantidos a cada mudança de dono ou de tropas, para que a
+// verificação das missões não precise varrer o mapa
+typedef struct {
+    int territorios[MAX_CORES];             // Territórios controlados por cada cor
+    long long tropas[MAX_CORES];            // Total de tropas de cada cor
+    int acimaLimite[MAX_CORES];             // Territórios com mais de LIMITE_TROPAS_MISSAO tropas
+    int centros[MAX_CORES];                 // Territórios com 2+ vizinhos da mesma cor
+    int posseOrigem[MAX_CORES][MAX_CORES];  // [dono][cor original] -> territórios
+    int coresOrigem[MAX_CORES];             // Cores originais distintas que cada cor controla
+} AgregadosMapa;
+
+// Resumo de uma cor recalculado por uma varredura completa das colunas, sem
+// usar os agregados: é o que basta para avaliar qualquer missão do jogo
+typedef struct {
+    int territorios;        // Territórios da cor
+    int maiorTropa;         // Maior número de tropas em um território da cor
+    int sequencias;         // Territórios da cor com a mesma cor nas posições t-1 e t+1
+    uint32_t coresOrigem;   // Conjunto (1 bit por ID) das cores originais dos territórios
+    long long tropas;       // Total de tropas da cor
+} ResumoCor;
+
+// Arena de memória de uma partida: um único bloco contíguo, reservado com mmap
+// (MAP_NORESERVE: só as páginas tocadas ocupam memória), onde o Jogo, os
+// jogadores e as colunas do mapa são alocados em sequência. Reiniciar a arena
+// é só voltar 'usado' a zero, e clonar uma partida é copiar 'usado' bytes.
+typedef struct {
+    char* inicio;
+    size_t usado;
+    size_t reservado;
+    size_t ultimo;          // Posição do último bloco (o único que cresce no lugar)
+} Arena;
+
+// Espaço de endereçamento reservado por padrão para a arena de uma partida
+#define TAMANHO_ARENA_PADRAO ((size_t)1 << 30)
+#define ALINHAMENTO_ARENA 64
+
+// Tipos de alteração registrados no diário de jogadas
+typedef enum {
+    ALTERACAO_TROPAS,
+    ALTERACAO_DONO
+} TipoAlteracao;
+
+// Registro compacto de uma alteração do mapa: valor anterior e novo
+typedef struct {
+    int32_t territorio;
+    int32_t anterior;       // Tropas ou ID de cor antes da alteração
+    int32_t novo;           // Tropas ou ID de cor depois da alteração
+    uint8_t tipo;           // TipoAlteracao
+    uint8_t fimJogada;      // 1 no último registro de uma jogada
+} AlteracaoMapa;
+
+// Diário das alterações feitas por definirTropas e definirDono. Desfazer e
+// refazer uma jogada custa O(alterações da jogada), sem copiar o mapa.
+typedef struct {
+    AlteracaoMapa* registros;
+    size_t total;           // Registros gravados, incluindo os que podem ser refeitos
+    size_t posicao;         // Registros aplicados; [posicao, total) podem ser refeitos
+    size_t capacidade;
+    int reproduzindo;       // 1 enquanto desfaz ou refaz (nada é gravado)
+} DiarioJogadas;
+
+// Definição da struct Mapa: territórios armazenados como vetores paralelos,
+// para que as varreduras de missão leiam apenas as colunas de que precisam
+typedef struct {
+    int quantidade;         // Territórios cadastrados
+    int capacidade;         // Territórios alocados
+    uint8_t* cor;           // ID da cor dona de cada território
+    uint8_t* corOriginal;   // ID da cor no momento do cadastro
+    int* tropas;            // Quantidade de tropas de cada território
+    uint32_t* nome;         // Posição do nome de cada território no pool de nomes
+    int* aliados;           // Vizinhos de cada território que têm a mesma cor
+    char* poolNomes;        // Nomes terminados em \0, armazenados em sequência
+    size_t tamanhoPool;
+    size_t capacidadePool;
+    // Índice de nomes com endereçamento aberto: cada posição guarda
+    // (hash << 32) | (território + 1), ou 0 se está livre
+    uint64_t* indiceNomes;
+    uint32_t capacidadeIndice;  // Potência de 2, com no máximo 2/3 das posições ocupadas
+    RegistroCores cores;
+    AgregadosMapa agregados;
+    // Grafo de fronteiras em CSR: os vizinhos de t são
+    // vizinhos[inicioVizinhos[t] .. inicioVizinhos[t + 1]), em ordem crescente.
+    // Sem grafo (NULL), qualquer território pode atacar qualquer outro e a
+    // vizinhança das missões segue a ordem do cadastro (t - 1 e t + 1).
+    int64_t* inicioVizinhos;
+    int* vizinhos;
+    void* mapeamento;       // Snapshot mapeado com mmap (NULL se as colunas usam malloc)
+    size_t tamanhoMapeamento;
+    Arena* arena;           // Arena das colunas e dos jogadores (NULL: malloc)
+    DiarioJogadas* diario;  // Diário das alterações (NULL: não grava)
+    uint64_t partidaLog;    // Partida no log de eventos (0: não registra)
+} Mapa;
+
+// Tipos de missão estratégica
+typedef enum {
+    MISSAO_SEQUENCIA,           // Conquistar N territórios consecutivos
+    MISSAO_ELIMINAR_COR,        // Eliminar uma cor do mapa
+    MISSAO_CONTROLAR,           // Controlar pelo menos N territórios
+    MISSAO_ACUMULAR,            // Mais de N tropas em um único território
+    MISSAO_CORES_DIFERENTES,    // Territórios de pelo menos N cores originais
+    MISSAO_TOTAL_TROPAS,        // Mais de N tropas somando todos os territórios
+    MISSAO_TERRITORIO,          // Conquistar um território pelo nome
+    TOTAL_TIPOS_MISSAO
+} TipoMissao;
+
+// Entrada da tabela de missões: tipo, parâmetro numérico e alvo (cor ou território)
+typedef struct {
+    TipoMissao tipo;
+    int parametro;
+    const char* alvo;
+} DefinicaoMissao;
+
+// Missão atribuída a um jogador, com os alvos já resolvidos para IDs e índices
+typedef struct {
+    TipoMissao tipo;
+    int parametro;
+    int definicao;          // Posição em missoesPredefinidas (texto e nome do alvo)
+    int corAlvo;            // ID da cor alvo (-1 se não se aplica)
+    int territorioAlvo;     // Índice do território alvo (-1 se não existe)
+} Missao;
+
 // Definição da struct Jogador para armazenar informações dos jogadores
 typedef struct {
     char nome[20];      // Nome do jogador
-    char cor[10];       // Cor do exército do jogador
-    char* missao;       // Missão estratégica (alocada dinamicamente)
+    uint8_t cor;        // ID da cor do exército do jogador
+    Missao missao;      // Missão estratégica sorteada
     int venceu;         // Flag para indicar se cumpriu a missão
 } Jogador;
 
 // Vetor global de missões estratégicas pré-definidas
-char* missoesPredefinidas[] = {
-    "Conquistar 3 territorios consecutivos da mesma cor",
-    "Eliminar todas as tropas de cor vermelha do mapa",
-    "Controlar pelo menos 5 territorios simultaneamente",
-    "Acumular mais de 15 tropas em um unico territorio",
-    "Conquistar territorios de pelo menos 3 cores diferentes",
+const DefinicaoMissao missoesPredefinidas[] = {
+    {MISSAO_SEQUENCIA, TAMANHO_SEQUENCIA_MISSAO, NULL},
+    {MISSAO_ELIMINAR_COR, 0, "Vermelho"},
+    {MISSAO_CONTROLAR, 5, NULL},
+    {MISSAO_ACUMULAR, LIMITE_TROPAS_MISSAO, NULL},
+    {MISSAO_CORES_DIFERENTES, 3, NULL},
+    {MISSAO_TOTAL_TROPAS, 20, NULL},    // Simplificação de "maior número total de tropas"
+    {MISSAO_TERRITORIO, 0, "Capital"}
+};
+
+#define TOTAL_MISSOES ((int)(sizeof(missoesPredefinidas) / sizeof(missoesPredefinidas[0])))
+
+// Modelos de texto de cada tipo de missão (%d recebe o parâmetro, %s o alvo)
+const char* modelosMissao[TOTAL_TIPOS_MISSAO] = {
+    "Conquistar %d territorios consecutivos da mesma cor",
+    "Eliminar todas as tropas de cor %s do mapa",
+    "Controlar pelo menos %d territorios simultaneamente",
+    "Acumular mais de %d tropas em um unico territorio",
+    "Conquistar territorios de pelo menos %d cores diferentes",
     "Ser o jogador com maior numero total de tropas",
-    "Conquistar o territorio chamado 'Capital' se existir"
+    "Conquistar o territorio chamado '%s' se existir"
+};
+
+#ifndef WAR_SEM_METRICAS
+// Métricas internas: contadores e histogramas de latência por thread, para
+// dimensionar máquinas e achar regressões. Compilar com -DWAR_SEM_METRICAS
+// remove toda a instrumentação; sem a variável de ambiente WAR_METRICAS cada
+// ponto de medição custa só o teste de uma flag.
+typedef enum {
+    CONTADOR_BATALHAS,              // Rodadas de batalha resolvidas (mapa e simulação em massa)
+    CONTADOR_CONQUISTAS,            // Rodadas que terminaram em conquista
+    CONTADOR_ATAQUES_REJEITADOS,    // Ataques recusados pelas regras
+    CONTADOR_DADOS_SORTEADOS,       // Valores de dado tirados do gerador
+    CONTADOR_VERIFICACOES_VITORIA,  // Buscas de vencedor
+    CONTADOR_COMANDOS_LOTE,         // Linhas interpretadas no modo em lote
+    CONTADOR_RENDERIZACOES,         // Exibições do mapa
+    TOTAL_CONTADORES
+} ContadorMetrica;
+
+typedef enum {
+    LATENCIA_ATAQUE,                // resolverAtaque
+    LATENCIA_VITORIA,               // encontrarVencedor
+    LATENCIA_COMANDO_LOTE,          // Uma linha do modo em lote
+    LATENCIA_RENDERIZACAO,          // renderizarMapa
+    TOTAL_LATENCIAS
+} LatenciaMetrica;
+
+const char* nomesContadores[TOTAL_CONTADORES] = {
+    "batalhas", "conquistas", "ataques_rejeitados", "dados_sorteados",
+    "verificacoes_vitoria", "comandos_lote", "renderizacoes"
 };
 
-const int TOTAL_MISSOES = 7;
+const char* nomesLatencias[TOTAL_LATENCIAS] = {
+    "ataque", "vitoria", "comando_lote", "renderizacao"
+};
+
+// Uma chamada a cada N é cronometrada: os caminhos de poucos nanossegundos
+// não pagam a leitura do relógio em toda chamada (os contadores são exatos)
+const uint32_t amostragemLatencias[TOTAL_LATENCIAS] = {64, 64, 1, 1};
+
+// Balde b do histograma: durações em [2^(b-1), 2^b) ns; o último acumula o resto
+#define BALDES_LATENCIA 40
+
+// Métricas de uma thread. Só a dona escreve (load + store relaxados, sem
+// instrução travada); a exportação lê os valores de todas as threads.
+typedef struct MetricasThread {
+    _Atomic uint64_t contadores[TOTAL_CONTADORES];
+    _Atomic uint64_t baldes[TOTAL_LATENCIAS][BALDES_LATENCIA];
+    _Atomic uint64_t somaNs[TOTAL_LATENCIAS];
+    uint32_t chamadas[TOTAL_LATENCIAS];     // Para a amostragem; só a dona usa
+    struct MetricasThread* proxima;
+} MetricasThread;
+
+static int metricasAtivas = 0;
+static const char* caminhoMetricas = NULL;
+static MetricasThread* listaMetricas = NULL;    // Nunca encolhe: threads encerradas continuam somando
+static pthread_mutex_t travaMetricas = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local MetricasThread* metricasDaThread = NULL;
+
+// Função para registrar o bloco de métricas da thread atual
+static MetricasThread* registrarMetricasThread(void) {
+    MetricasThread* metricas = (MetricasThread*)calloc(1, sizeof(MetricasThread));
+    if (metricas == NULL) {
+        printf("Erro: Falha na alocação de memória para as métricas!\n");
+        exit(1);
+    }
+    pthread_mutex_lock(&travaMetricas);
+    metricas->proxima = listaMetricas;
+    listaMetricas = metricas;
+    pthread_mutex_unlock(&travaMetricas);
+    metricasDaThread = metricas;
+    return metricas;
+}
+
+// Função para obter as métricas da thread atual
+static inline MetricasThread* obterMetricasThread(void) {
+    return metricasDaThread != NULL ? metricasDaThread : registrarMetricasThread();
+}
+
+// Função para somar a um valor que só a thread atual escreve
+static inline void somarMetrica(_Atomic uint64_t* valor, uint64_t quantidade) {
+    atomic_store_explicit(valor, atomic_load_explicit(valor, memory_order_relaxed) + quantidade, 
+                          memory_order_relaxed);
+}
+
+// Função para incrementar um contador
+static inline void contarMetrica(ContadorMetrica contador, uint64_t quantidade) {
+    if (__builtin_expect(!metricasAtivas, 1)) return;
+    somarMetrica(&obterMetricasThread()->contadores[contador], quantidade);
+}
+
+// Função para ler o relógio monotônico em nanossegundos
+static inline uint64_t relogioNs(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t)agora.tv_sec * 1000000000u + (uint64_t)agora.tv_nsec;
+}
+
+// Função para iniciar uma medição; retorna 0 quando esta chamada não é amostrada
+static inline uint64_t iniciarMedicao(LatenciaMetrica latencia) {
+    if (__builtin_expect(!metricasAtivas, 1)) return 0;
+    MetricasThread* metricas = obterMetricasThread();
+    if (metricas->chamadas[latencia]++ % amostragemLatencias[latencia] != 0) return 0;
+    return relogioNs();
+}
+
+// Função para encerrar uma medição e registrá-la no histograma
+static inline void encerrarMedicao(LatenciaMetrica latencia, uint64_t inicio) {
+    if (inicio == 0) return;
+    uint64_t duracao = relogioNs() - inicio;
+    int balde = duracao == 0 ? 0 : 64 - __builtin_clzll(duracao);
+    if (balde >= BALDES_LATENCIA) balde = BALDES_LATENCIA - 1;
+    MetricasThread* metricas = obterMetricasThread();
+    somarMetrica(&metricas->baldes[latencia][balde], 1);
+    somarMetrica(&metricas->somaNs[latencia], duracao);
+}
+
+#define CONTAR_METRICA(contador, quantidade) contarMetrica(contador, quantidade)
+#define INICIAR_MEDICAO(latencia) uint64_t inicioMedicao = iniciarMedicao(latencia)
+#define ENCERRAR_MEDICAO(latencia) encerrarMedicao(latencia, inicioMedicao)
+#else
+#define CONTAR_METRICA(contador, quantidade) ((void)0)
+#define INICIAR_MEDICAO(latencia) ((void)0)
+#define ENCERRAR_MEDICAO(latencia) ((void)0)
+#endif
+
+// Log binário de eventos: registros de tamanho fixo, só acrescentados, para
+// analisar milhares de partidas depois (war --analisar-log). Ativado pela
+// variável WAR_LOG=<prefixo>; sem ela cada ponto de registro custa o teste
+// de um campo do mapa. Cada thread acumula registros no seu buffer e só
+// trava o arquivo para gravar o buffer inteiro com um write().
+#define MAGICO_LOG "WARLOG1"
+#define VERSAO_LOG 1
+#define MARCA_ENDIAN_LOG 0x01020304u
+#define EVENTOS_BUFFER_LOG 2048             // 64 KiB por thread
+#define TAMANHO_PADRAO_ARQUIVO_LOG 1024     // MiB por arquivo antes da rotação
+
+// Tipos de registro do log
+typedef enum {
+    EVENTO_PARTIDA = 1,     // Início de partida
+    EVENTO_TERRITORIO,      // Cadastro: origem = território, deltaOrigem = tropas, cor = dono
+    EVENTO_MISSAO,          // Missão: origem = jogador, destino = posição em missoesPredefinidas, cor = jogador
+    EVENTO_ATAQUE,          // Uma rolagem: origem/destino, variação das tropas, dados e conquista
+    EVENTO_BLITZ,           // Ataque relâmpago inteiro: como EVENTO_ATAQUE, extra = rodadas
+    EVENTO_FIM              // Fim: origem = vencedor (-1 sem vencedor), destino = missão do vencedor
+} TipoEvento;
+
+// Registro do log (32 bytes, no formato da máquina que gravou)
+typedef struct {
+    uint64_t partida;       // (execução << 32) | número da partida na execução
+    int32_t origem;
+    int32_t destino;
+    int32_t deltaOrigem;
+    int32_t deltaDestino;
+    uint32_t extra;
+    uint8_t tipo;           // TipoEvento
+    uint8_t cor;            // Cor do atacante, do dono ou do jogador
+    uint8_t dados;          // Dado do atacante << 4 | dado do defensor (regra no blitz)
+    uint8_t conquistou;     // 1 se o destino mudou de dono
+} EventoLog;
+_Static_assert(sizeof(EventoLog) == 32, "registro do log deve ter 32 bytes");
+
+// Cabeçalho de cada arquivo do log, seguido dos registros
+typedef struct {
+    char magico[8];
+    uint32_t versao;
+    uint32_t tamanhoEvento;
+    uint32_t marcaEndian;
+    uint32_t sequencia;     // Posição do arquivo na rotação
+    uint64_t execucao;
+    uint8_t reservado[32];
+} CabecalhoLog;
+_Static_assert(sizeof(CabecalhoLog) == 64, "cabeçalho do log deve ter 64 bytes");
+
+// Buffer de registros de uma thread
+typedef struct BufferLog {
+    EventoLog eventos[EVENTOS_BUFFER_LOG];
+    int total;
+    struct BufferLog* proximo;
+} BufferLog;
+
+static int logAtivo = 0;
+static const char* prefixoLog = NULL;
+static uint64_t execucaoLog = 0;
+static uint64_t limiteArquivoLog = 0;
+static _Atomic uint32_t proximaPartidaLog = 1;
+static int descritorLog = -1;
+static uint32_t sequenciaLog = 0;
+static uint64_t gravadoLog = 0;             // Bytes no arquivo atual
+static BufferLog* listaBuffersLog = NULL;   // Descarregados na saída do programa
+static pthread_mutex_t travaLog = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local BufferLog* bufferLogDaThread = NULL;
+static pthread_key_t chaveBufferLog;        // Descarrega e libera o buffer quando a thread termina
+static pthread_once_t chaveBufferLogCriada = PTHREAD_ONCE_INIT;
+
+// Função para abrir o próximo arquivo do log (chamada com travaLog). Nunca
+// sobrescreve: pula as sequências que já existem. Retorna 1 em caso de sucesso.
+static int abrirArquivoLog(void) {
+    char caminho[4096];
+    CabecalhoLog cabecalho;
+    
+    if (descritorLog >= 0) close(descritorLog);
+    descritorLog = -1;
+    for (int tentativas = 0; tentativas < 1000000 && descritorLog < 0; tentativas++) {
+        snprintf(caminho, sizeof(caminho), "%s.%06u.wlog", prefixoLog, sequenciaLog++);
+        descritorLog = open(caminho, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+        if (descritorLog < 0 && errno != EEXIST) break;
+    }
+    if (descritorLog < 0) return 0;
+    
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magico, MAGICO_LOG, sizeof(MAGICO_LOG));
+    cabecalho.versao = VERSAO_LOG;
+    cabecalho.tamanhoEvento = sizeof(EventoLog);
+    cabecalho.marcaEndian = MARCA_ENDIAN_LOG;
+    cabecalho.sequencia = sequenciaLog - 1;
+    cabecalho.execucao = execucaoLog;
+    gravadoLog = 0;
+    if (write(descritorLog, &cabecalho, sizeof(cabecalho)) != (ssize_t)sizeof(cabecalho)) return 0;
+    gravadoLog = sizeof(cabecalho);
+    return 1;
+}
+
+// Função para gravar o buffer de uma thread no arquivo atual, girando o
+// arquivo quando ele passa do limite. Um erro desliga o log (o jogo continua).
+static void descarregarBufferLog(BufferLog* buffer) {
+    size_t tamanho = (size_t)buffer->total * sizeof(EventoLog);
+    const char* dados = (const char*)buffer->eventos;
+    
+    pthread_mutex_lock(&travaLog);
+    if (logAtivo && tamanho > 0) {
+        int ok = descritorLog >= 0 || abrirArquivoLog();
+        if (ok && gravadoLog > sizeof(CabecalhoLog) && gravadoLog + tamanho > limiteArquivoLog) {
+            ok = abrirArquivoLog();
+        }
+        while (ok && tamanho > 0) {
+            ssize_t escritos = write(descritorLog, dados, tamanho);
+            if (escritos < 0 && errno == EINTR) continue;
+            if (escritos <= 0) {
+                ok = 0;
+                break;
+            }
+            dados += escritos;
+            tamanho -= (size_t)escritos;
+            gravadoLog += (uint64_t)escritos;
+        }
+        if (!ok) {
+            fprintf(stderr, "Erro: Não foi possível gravar o log de eventos '%s'; log desativado.\n", prefixoLog);
+            logAtivo = 0;
+        }
+    }
+    pthread_mutex_unlock(&travaLog);
+    buffer->total = 0;
+}
+
+// Função chamada quando uma thread com buffer de log termina: grava o que
+// ficou pendente, tira o buffer da lista e o libera
+static void liberarBufferLog(void* argumento) {
+    BufferLog* buffer = (BufferLog*)argumento;
+    descarregarBufferLog(buffer);
+    
+    pthread_mutex_lock(&travaLog);
+    BufferLog** elo = &listaBuffersLog;
+    while (*elo != NULL && *elo != buffer) elo = &(*elo)->proximo;
+    if (*elo != NULL) *elo = buffer->proximo;
+    pthread_mutex_unlock(&travaLog);
+    free(buffer);
+}
+
+// Função auxiliar para criar a chave dos buffers (uma única vez)
+static void criarChaveBufferLog(void) {
+    pthread_key_create(&chaveBufferLog, liberarBufferLog);
+}
+
+// Função para registrar o buffer de log da thread atual
+static BufferLog* registrarBufferLog(void) {
+    BufferLog* buffer = (BufferLog*)calloc(1, sizeof(BufferLog));
+    if (buffer == NULL) {
+        printf("Erro: Falha na alocação de memória para o log de eventos!\n");
+        exit(1);
+    }
+    pthread_mutex_lock(&travaLog);
+    buffer->proximo = listaBuffersLog;
+    listaBuffersLog = buffer;
+    pthread_mutex_unlock(&travaLog);
+    pthread_once(&chaveBufferLogCriada, criarChaveBufferLog);
+    pthread_setspecific(chaveBufferLog, buffer);
+    bufferLogDaThread = buffer;
+    return buffer;
+}
+
+// Função para acrescentar um registro ao buffer da thread (sem trava)
+static void registrarEvento(const EventoLog* evento) {
+    BufferLog* buffer = bufferLogDaThread != NULL ? bufferLogDaThread : registrarBufferLog();
+    buffer->eventos[buffer->total++] = *evento;
+    if (buffer->total == EVENTOS_BUFFER_LOG) descarregarBufferLog(buffer);
+}
+
+// Função para reservar o identificador de uma nova partida no log (0: log desligado)
+static uint64_t novaPartidaLog(void) {
+    if (!logAtivo) return 0;
+    uint32_t numero = atomic_fetch_add_explicit(&proximaPartidaLog, 1, memory_order_relaxed);
+    return (execucaoLog << 32) | numero;
+}
+
+// Função para gravar os buffers das threads ainda vivas e fechar o log (na
+// saída do programa; as que já terminaram gravaram o seu em liberarBufferLog)
+static void encerrarLog(void) {
+    for (BufferLog* buffer = listaBuffersLog; buffer != NULL; buffer = buffer->proximo) {
+        descarregarBufferLog(buffer);
+    }
+    pthread_mutex_lock(&travaLog);
+    if (descritorLog >= 0) close(descritorLog);
+    descritorLog = -1;
+    pthread_mutex_unlock(&travaLog);
+}
+
+// Estado do gerador aleatório xoshiro256**. Cada thread ou jogo tem o seu,
+// então não há estado global escondido e uma semente reproduz a partida.
+typedef struct {
+    uint64_t s[4];
+} GeradorAleatorio;
+
+// Função auxiliar para rotação de bits à esquerda
+static inline uint64_t rotacionar64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Função splitmix64, usada apenas para espalhar a semente no estado inicial
+uint64_t splitmix64(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Função para inicializar um gerador a partir de uma semente e de um número de fluxo.
+// Fluxos diferentes com a mesma semente produzem sequências independentes
+// (uma por thread, por jogo etc.).
+void inicializarGerador(GeradorAleatorio* gerador, uint64_t semente, uint64_t fluxo) {
+    uint64_t mistura = fluxo;
+    uint64_t estado = semente ^ splitmix64(&mistura);
+    for (int i = 0; i < 4; i++) {
+        gerador->s[i] = splitmix64(&estado);
+    }
+}
+
+// Função que produz o próximo número de 64 bits (xoshiro256**)
+static inline uint64_t proximoAleatorio(GeradorAleatorio* gerador) {
+    uint64_t* s = gerador->s;
+    uint64_t resultado = rotacionar64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionar64(s[3], 45);
+    
+    return resultado;
+}
+
+// Função para sortear um inteiro em [0, limite) sem viés de módulo (método de Lemire)
+static inline int sortearIntervalo(GeradorAleatorio* gerador, uint32_t limite) {
+    uint32_t minimoAceito = (uint32_t)(-limite) % limite;
+    uint64_t produto;
+    do {
+        produto = (uint64_t)(uint32_t)proximoAleatorio(gerador) * limite;
+    } while ((uint32_t)produto < minimoAceito);
+    return (int)(produto >> 32);
+}
+
+// Função para preencher um buffer com valores de dado (1 a 6) em uma única chamada.
+// Cada número de 64 bits rende dois dados; a rejeição mantém a distribuição uniforme.
+void preencherDados(GeradorAleatorio* gerador, uint8_t* destino, size_t quantidade) {
+    const uint32_t minimoAceito = (uint32_t)(-6u) % 6u;
+    size_t i = 0;
+    
+    CONTAR_METRICA(CONTADOR_DADOS_SORTEADOS, quantidade);
+    while (i < quantidade) {
+        uint64_t bruto = proximoAleatorio(gerador);
+        for (int metade = 0; metade < 2 && i < quantidade; metade++) {
+            uint64_t produto = (uint64_t)(uint32_t)bruto * 6u;
+            bruto >>= 32;
+            if ((uint32_t)produto >= minimoAceito) {
+                destino[i++] = (uint8_t)((produto >> 32) + 1);
+            }
+        }
+    }
+}
+
+// Estado completo de uma partida: mapa, jogadores e gerador aleatório
+typedef struct {
+    Mapa mapa;
+    Jogador* jogadores;
+    int numJogadores;
+    int capacidadeJogadores;
+    GeradorAleatorio gerador;
+    uint64_t semente;
+    int vencedor;           // Índice do vencedor (-1 enquanto ninguém venceu)
+    long long ataques;      // Ataques realizados na partida
+} Jogo;
+
+// Motivos pelos quais um ataque pode ser recusado
+typedef enum {
+    ATAQUE_VALIDO,
+    ATAQUE_MESMO_TERRITORIO,
+    ATAQUE_TROPAS_INSUFICIENTES,
+    ATAQUE_MESMA_COR,
+    ATAQUE_SEM_FRONTEIRA
+} MotivoAtaque;
+
+// Limite de threads usadas pela simulação em massa
+#define MAX_THREADS_SIMULACAO 256
+
+// Resultado de uma rodada de batalha (sem nenhuma saída no terminal)
+typedef struct {
+    int conquistou;          // 1 se o atacante venceu e tomou o território
+    int tropasTransferidas;  // Tropas movidas para o território conquistado
+    int perdaAtacante;       // Tropas perdidas pelo atacante (0 ou 1)
+    int perdaDefensor;       // Tropas do defensor eliminadas na conquista
+} ResultadoBatalha;
+
+// Regras de dados do ataque relâmpago (blitz)
+typedef enum {
+    DADOS_UM_A_UM,          // Regra do jogo: 1 dado contra 1, conquista na primeira vitória
+    DADOS_CLASSICOS         // War clássico: até 3 dados contra até 2, uma baixa por par comparado
+} RegraDados;
+
+// Resultado de um ataque relâmpago: rodadas repetidas até conquistar, o
+// atacante ficar com 1 tropa ou o limite de rodadas acabar
+typedef struct {
+    int rodadas;             // Rolagens feitas
+    int conquistou;          // 1 se o território foi tomado
+    int perdasAtacante;      // Tropas perdidas pelo atacante
+    int perdasDefensor;      // Tropas do defensor eliminadas
+    int tropasTransferidas;  // Tropas movidas para o território conquistado
+} ResultadoBlitz;
+
+// Estatísticas agregadas de uma simulação em massa
+typedef struct {
+    long long batalhas;
+    long long vitoriasAtacante;
+    long long vitoriasDefensor;
+    long long tropasPerdidasAtacante;
+    long long tropasPerdidasDefensor;
+    long long tropasTransferidas;
+} EstatisticasSimulacao;
+
+// Contagem de uma rolagem 1x1, calculada em tempo de compilação: o dado do
+// atacante precisa ser estritamente maior, então a face f vence f - 1 faces
+// do defensor e as vitórias somam 0 + 1 + ... + (FACES_DADO - 1)
+#define FACES_DADO 6
+#define COMBINACOES_ROLAGEM (FACES_DADO * FACES_DADO)
+#define VITORIAS_ROLAGEM (FACES_DADO * (FACES_DADO - 1) / 2)
+_Static_assert(VITORIAS_ROLAGEM == 15, "o atacante vence 15 das 36 combinações");
+
+// Chances exatas de um ataque, calculadas sem sortear nada. Os valores de
+// tropas são esperanças sobre todos os desfechos (0 nos desfechos em que não se aplicam).
+typedef struct {
+    double conquista;           // Probabilidade de tomar o território
+    double tropasAtacante;      // Tropas esperadas no território atacante ao final
+    double tropasOcupacao;      // Tropas esperadas movidas para o território conquistado
+    double tropasDefensor;      // Tropas esperadas que o defensor mantém
+    double rodadas;             // Rolagens esperadas
+} ChancesAtaque;
+
+// Ataques repetidos com até este número de tropas usam a tabela memorizada
+#define MAX_TROPAS_MEMO 4096
+
+// Função para buscar o ID de uma cor já registrada (-1 se não existir)
+int buscarCor(const RegistroCores* cores, const char* nome) {
+    for (int i = 0; i < cores->total; i++) {
+        if (strcasecmp(cores->nomes[i], nome) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Função para registrar uma cor e obter seu ID (reaproveita o ID se já existir)
+uint8_t registrarCor(RegistroCores* cores, const char* nome) {
+    int id = buscarCor(cores, nome);
+    if (id >= 0) return (uint8_t)id;
+    
+    if (cores->total >= MAX_CORES) {
+        printf("Erro: Limite de %d cores diferentes atingido!\n", MAX_CORES);
+        exit(1);
+    }
+    snprintf(cores->nomes[cores->total], sizeof(cores->nomes[0]), "%s", nome);
+    return (uint8_t)cores->total++;
+}
+
+// Função para obter o nome de uma cor a partir do seu ID
+const char* nomeCor(const RegistroCores* cores, uint8_t id) {
+    return cores->nomes[id];
+}
+
+// Função para obter o nome de um território a partir do seu índice
+const char* nomeTerritorio(const Mapa* mapa, int indice) {
+    return mapa->poolNomes + mapa->nome[indice];
+}
+
+// Função para calcular o hash de um nome (FNV-1a de 64 bits com mistura final)
+static uint64_t hashNome(const char* nome) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char* p = (const unsigned char*)nome; *p != '\0'; p++) {
+        hash = (hash ^ *p) * 0x100000001b3ULL;
+    }
+    hash ^= hash >> 32;
+    hash *= 0xd6e8feb86659fd93ULL;
+    return hash ^ (hash >> 32);
+}
+
+// Função auxiliar para achar a posição do índice onde está 'nome' (ou a
+// posição livre onde ele entraria). A parte alta do hash fica guardada na
+// entrada, então strcmp só é chamado quando os 32 bits coincidem.
+static uint32_t sondarIndiceNomes(const Mapa* mapa, const char* nome, uint64_t hash) {
+    uint32_t marca = (uint32_t)(hash >> 32);
+    uint32_t mascara = mapa->capacidadeIndice - 1;
+    uint32_t posicao = (uint32_t)hash & mascara;
+    for (;;) {
+        uint64_t entrada = mapa->indiceNomes[posicao];
+        if (entrada == 0) return posicao;
+        if ((uint32_t)(entrada >> 32) == marca && 
+            strcmp(nomeTerritorio(mapa, (int)(uint32_t)entrada - 1), nome) == 0) {
+            return posicao;
+        }
+        posicao = (posicao + 1) & mascara;
+    }
+}
+
+// Função para buscar um território pelo nome em O(1) esperado.
+// Retorna o índice do território ou -1 se não existe.
+int buscarTerritorio(const Mapa* mapa, const char* nome) {
+    if (mapa->indiceNomes == NULL) return -1;
+    uint64_t entrada = mapa->indiceNomes[sondarIndiceNomes(mapa, nome, hashNome(nome))];
+    return entrada != 0 ? (int)(uint32_t)entrada - 1 : -1;
+}
+
+// Função para interpretar um território digitado: posição (1 a N) ou nome.
+// Uma posição válida tem precedência sobre um território com nome numérico.
+// Retorna o índice do território ou -1 se não existe.
+int interpretarTerritorio(const Mapa* mapa, const char* texto) {
+    char* fim;
+    if (texto == NULL) return -1;
+    long long posicao = strtoll(texto, &fim, 10);
+    if (fim != texto && *fim == '\0' && posicao >= 1 && posicao <= mapa->quantidade) {
+        return (int)posicao - 1;
+    }
+    return buscarTerritorio(mapa, texto);
+}
+
+// Função para reservar uma arena com 'reservado' bytes de espaço de endereçamento.
+// Retorna 1 em caso de sucesso e 0 se o mmap falhar.
+int criarArena(Arena* arena, size_t reservado) {
+    void* inicio = mmap(NULL, reservado, PROT_READ | PROT_WRITE, 
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    memset(arena, 0, sizeof(Arena));
+    if (inicio == MAP_FAILED) return 0;
+    arena->inicio = (char*)inicio;
+    arena->reservado = reservado;
+    return 1;
+}
+
+// Função para devolver ao sistema todo o espaço de uma arena
+void destruirArena(Arena* arena) {
+    if (arena->inicio != NULL) munmap(arena->inicio, arena->reservado);
+    memset(arena, 0, sizeof(Arena));
+}
+
+// Função para descartar tudo o que foi alocado na arena (O(1), sem liberar páginas)
+void reiniciarArena(Arena* arena) {
+    arena->usado = 0;
+    arena->ultimo = 0;
+}
+
+// Função para alocar um bloco na arena, alinhado a ALINHAMENTO_ARENA bytes e
+// sem inicialização. Retorna NULL se a arena estiver cheia.
+void* alocarArena(Arena* arena, size_t tamanho) {
+    size_t posicao = (arena->usado + ALINHAMENTO_ARENA - 1) & ~(size_t)(ALINHAMENTO_ARENA - 1);
+    if (posicao > arena->reservado || tamanho > arena->reservado - posicao) return NULL;
+    arena->ultimo = posicao;
+    arena->usado = posicao + tamanho;
+    return arena->inicio + posicao;
+}
+
+// Funções de alocação das estruturas de uma partida: usam a arena quando há
+// uma e calloc/realloc/free caso contrário. Blocos novos vêm zerados.
+static void* alocarMemoriaJogo(Arena* arena, size_t tamanho) {
+    if (arena == NULL) return calloc(1, tamanho > 0 ? tamanho : 1);
+    void* bloco = alocarArena(arena, tamanho);
+    if (bloco != NULL) memset(bloco, 0, tamanho);
+    return bloco;
+}
+
+static void* realocarMemoriaJogo(Arena* arena, void* bloco, size_t tamanhoAntigo, size_t tamanhoNovo) {
+    if (arena == NULL) return realloc(bloco, tamanhoNovo);
+    if (bloco != NULL && (char*)bloco == arena->inicio + arena->ultimo) {
+        // Último bloco da arena: cresce no lugar
+        if (tamanhoNovo > arena->reservado - arena->ultimo) return NULL;
+        arena->usado = arena->ultimo + tamanhoNovo;
+        return bloco;
+    }
+    // Os demais são copiados; o espaço antigo só volta no reinício da arena
+    void* novo = alocarArena(arena, tamanhoNovo);
+    if (novo != NULL && bloco != NULL) {
+        memcpy(novo, bloco, tamanhoAntigo < tamanhoNovo ? tamanhoAntigo : tamanhoNovo);
+    }
+    return novo;
+}
+
+static void liberarMemoriaJogo(Arena* arena, void* bloco) {
+    if (arena == NULL) {
+        free(bloco);
+    } else if (bloco != NULL && (char*)bloco == arena->inicio + arena->ultimo) {
+        arena->usado = arena->ultimo; // Devolve o último bloco; os demais esperam o reinício
+    }
+}
+
+// Função para deixar um mapa vazio, pronto para registrar cores e territórios
+void inicializarMapa(Mapa* mapa) {
+    memset(mapa, 0, sizeof(Mapa));
+}
+
+// Função para obter os vizinhos de um território: os do grafo, se houver,
+// ou os adjacentes na ordem do cadastro (escritos em 'implicitos')
+static inline int listarVizinhos(const Mapa* mapa, int territorio, const int** lista, int implicitos[2]) {
+    if (mapa->vizinhos != NULL) {
+        *lista = mapa->vizinhos + mapa->inicioVizinhos[territorio];
+        return (int)(mapa->inicioVizinhos[territorio + 1] - mapa->inicioVizinhos[territorio]);
+    }
+    int total = 0;
+    if (territorio > 0) implicitos[total++] = territorio - 1;
+    if (territorio + 1 < mapa->quantidade) implicitos[total++] = territorio + 1;
+    *lista = implicitos;
+    return total;
+}
+
+// Função para retirar (delta = -1) ou somar (delta = +1) um território na contagem
+// de vizinhos aliados, mantendo os centros de sequência (caminhos de 3 territórios
+// da mesma cor têm sempre um território central com 2 vizinhos aliados). Custa O(grau).
+static void contarAliados(Mapa* mapa, int territorio, int delta) {
+    uint8_t cor = mapa->cor[territorio];
+    int* centros = &mapa->agregados.centros[cor];
+    int implicitos[2];
+    const int* vizinhos;
+    int grau = listarVizinhos(mapa, territorio, &vizinhos, implicitos);
+    int aliados = 0;
+    
+    for (int i = 0; i < grau; i++) {
+        int vizinho = vizinhos[i];
+        if (mapa->cor[vizinho] != cor) continue;
+        aliados++;
+        if (delta < 0 && mapa->aliados[vizinho]-- == 2) (*centros)--;
+        if (delta > 0 && ++mapa->aliados[vizinho] == 2) (*centros)++;
+    }
+    
+    if (delta < 0) {
+        if (mapa->aliados[territorio] >= 2) (*centros)--;
+        mapa->aliados[territorio] = 0;
+    } else {
+        mapa->aliados[territorio] = aliados;
+        if (aliados >= 2) (*centros)++;
+    }
+}
+
+// Função para somar (delta = +1) ou retirar (delta = -1) um território da posse de uma cor
+static void contarPosse(Mapa* mapa, int indice, uint8_t dono, int delta) {
+    AgregadosMapa* agregados = &mapa->agregados;
+    int* posse = &agregados->posseOrigem[dono][mapa->corOriginal[indice]];
+    
+    if (delta > 0 && (*posse)++ == 0) agregados->coresOrigem[dono]++;
+    if (delta < 0 && --(*posse) == 0) agregados->coresOrigem[dono]--;
+    
+    agregados->territorios[dono] += delta;
+    agregados->tropas[dono] += delta * (long long)mapa->tropas[indice];
+    if (mapa->tropas[indice] > LIMITE_TROPAS_MISSAO) agregados->acimaLimite[dono] += delta;
+}
+
+// Função para gravar uma alteração no diário do mapa. Uma alteração nova
+// descarta as jogadas desfeitas que ainda poderiam ser refeitas.
+static void registrarAlteracao(Mapa* mapa, TipoAlteracao tipo, int territorio, int anterior, int novo) {
+    DiarioJogadas* diario = mapa->diario;
+    if (diario == NULL || diario->reproduzindo || anterior == novo) return;
+    
+    diario->total = diario->posicao;
+    if (diario->total == diario->capacidade) {
+        size_t novaCapacidade = diario->capacidade > 0 ? diario->capacidade * 2 : 256;
+        AlteracaoMapa* novos = (AlteracaoMapa*)realloc(diario->registros, novaCapacidade * sizeof(AlteracaoMapa));
+        if (novos == NULL) {
+            printf("Erro: Não foi possível alocar memória para o diário de jogadas!\n");
+            exit(1);
+        }
+        diario->registros = novos;
+        diario->capacidade = novaCapacidade;
+    }
+    
+    AlteracaoMapa* registro = &diario->registros[diario->total++];
+    registro->territorio = territorio;
+    registro->anterior = anterior;
+    registro->novo = novo;
+    registro->tipo = (uint8_t)tipo;
+    registro->fimJogada = 0;
+    diario->posicao = diario->total;
+}
+
+// Função para alterar as tropas de um território mantendo os agregados em O(1)
+void definirTropas(Mapa* mapa, int indice, int tropas) {
+    AgregadosMapa* agregados = &mapa->agregados;
+    uint8_t dono = mapa->cor[indice];
+    int anteriores = mapa->tropas[indice];
+    
+    if (mapa->diario != NULL) registrarAlteracao(mapa, ALTERACAO_TROPAS, indice, anteriores, tropas);
+    agregados->tropas[dono] += tropas - anteriores;
+    agregados->acimaLimite[dono] += (tropas > LIMITE_TROPAS_MISSAO) - (anteriores > LIMITE_TROPAS_MISSAO);
+    mapa->tropas[indice] = tropas;
+}
+
+// Função para trocar o dono de um território mantendo os agregados (O(grau))
+void definirDono(Mapa* mapa, int indice, uint8_t cor) {
+    if (mapa->cor[indice] == cor) return;
+    
+    if (mapa->diario != NULL) registrarAlteracao(mapa, ALTERACAO_DONO, indice, mapa->cor[indice], cor);
+    contarAliados(mapa, indice, -1);
+    contarPosse(mapa, indice, mapa->cor[indice], -1);
+    mapa->cor[indice] = cor;
+    contarPosse(mapa, indice, cor, +1);
+    contarAliados(mapa, indice, +1);
+}
+
+// Função para encerrar a jogada atual no diário: desfazer volta até aqui
+void marcarJogada(DiarioJogadas* diario) {
+    if (diario != NULL && diario->posicao > 0) diario->registros[diario->posicao - 1].fimJogada = 1;
+}
+
+// Função auxiliar para aplicar um valor de um registro pelo setter correspondente
+static void aplicarAlteracao(Mapa* mapa, const AlteracaoMapa* registro, int valor) {
+    if (registro->tipo == ALTERACAO_TROPAS) definirTropas(mapa, registro->territorio, valor);
+    else definirDono(mapa, registro->territorio, (uint8_t)valor);
+}
+
+// Função para desfazer a última jogada do diário, em ordem inversa e pelos
+// setters (os agregados continuam corretos). Retorna quantas alterações foram
+// desfeitas (0 se não havia o que desfazer).
+int desfazerJogada(Mapa* mapa) {
+    DiarioJogadas* diario = mapa->diario;
+    int desfeitas = 0;
+    if (diario == NULL || diario->posicao == 0) return 0;
+    
+    diario->reproduzindo = 1;
+    do {
+        const AlteracaoMapa* registro = &diario->registros[--diario->posicao];
+        aplicarAlteracao(mapa, registro, registro->anterior);
+        desfeitas++;
+    } while (diario->posicao > 0 && !diario->registros[diario->posicao - 1].fimJogada);
+    diario->reproduzindo = 0;
+    return desfeitas;
+}
+
+// Função para refazer a próxima jogada desfeita. Retorna quantas alterações
+// foram reaplicadas (0 se não havia o que refazer).
+int refazerJogada(Mapa* mapa) {
+    DiarioJogadas* diario = mapa->diario;
+    int refeitas = 0;
+    if (diario == NULL) return 0;
+    
+    diario->reproduzindo = 1;
+    while (diario->posicao < diario->total) {
+        const AlteracaoMapa* registro = &diario->registros[diario->posicao++];
+        aplicarAlteracao(mapa, registro, registro->novo);
+        refeitas++;
+        if (registro->fimJogada) break;
+    }
+    diario->reproduzindo = 0;
+    return refeitas;
+}
+
+// Função para esvaziar o diário, mantendo a memória para a próxima partida
+void limparDiario(DiarioJogadas* diario) {
+    diario->total = 0;
+    diario->posicao = 0;
+    diario->reproduzindo = 0;
+}
+
+// Função para reservar as colunas de 'quantidade' territórios, sem I/O.
+// Retorna 1 em caso de sucesso e 0 se faltou memória.
+int reservarTerritorios(Mapa* mapa, int quantidade) {
+    Arena* arena = mapa->arena;
+    mapa->cor = (uint8_t*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(uint8_t));
+    mapa->corOriginal = (uint8_t*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(uint8_t));
+    mapa->tropas = (int*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(int));
+    mapa->nome = (uint32_t*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(uint32_t));
+    mapa->aliados = (int*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(int));
+    // Índice de nomes com folga de pelo menos 1/3 (alocado zerado: tudo livre)
+    uint64_t posicoes = 16;
+    while (posicoes < (uint64_t)quantidade + (uint64_t)quantidade / 2) posicoes *= 2;
+    if (posicoes > ((uint64_t)1 << 31)) return 0;
+    mapa->capacidadeIndice = (uint32_t)posicoes;
+    mapa->indiceNomes = (uint64_t*)alocarMemoriaJogo(arena, (size_t)posicoes * sizeof(uint64_t));
+    // Estimativa inicial do pool; cresce sob demanda em adicionarTerritorio
+    // (por ser o último bloco, na arena cresce no lugar)
+    mapa->capacidadePool = (size_t)quantidade * 12 + 64;
+    mapa->poolNomes = (char*)alocarMemoriaJogo(arena, mapa->capacidadePool);
+    
+    if (mapa->cor == NULL || mapa->corOriginal == NULL || mapa->tropas == NULL || 
+        mapa->nome == NULL || mapa->aliados == NULL || mapa->indiceNomes == NULL || 
+        mapa->poolNomes == NULL) {
+        return 0;
+    }
+    mapa->capacidade = quantidade;
+    mapa->quantidade = 0;
+    mapa->tamanhoPool = 0;
+    return 1;
+}
+
+// Função para alocar memória dinamicamente para as colunas dos territórios
+void alocarTeritorios(Mapa* mapa, int quantidade) {
+    if (!reservarTerritorios(mapa, quantidade)) {
+        printf("Erro: Não foi possível alocar memória para os territórios!\n");
+        exit(1);
+    }
+    printf("Memória alocada com sucesso para %d territórios.\n", quantidade);
+}
+
+// Função para incluir um território no mapa, internando sua cor e seu nome.
+// Retorna o índice do território ou -1 se já existe um território com esse nome.
+int adicionarTerritorio(Mapa* mapa, const Territorio* territorio) {
+    if (mapa->quantidade >= mapa->capacidade) {
+        printf("Erro: O mapa já está cheio (%d territórios)!\n", mapa->capacidade);
+        exit(1);
+    }
+    
+    // Nomes são únicos: a posição livre encontrada já é a do novo território
+    uint64_t hash = hashNome(territorio->nome);
+    uint32_t posicaoIndice = sondarIndiceNomes(mapa, territorio->nome, hash);
+    if (mapa->indiceNomes[posicaoIndice] != 0) return -1;
+    
+    // Garantir espaço no pool de nomes
+    size_t tamanhoNome = strlen(territorio->nome) + 1;
+    if (mapa->tamanhoPool + tamanhoNome > mapa->capacidadePool) {
+        size_t novaCapacidade = mapa->capacidadePool * 2 + tamanhoNome;
+        char* novoPool = (char*)realocarMemoriaJogo(mapa->arena, mapa->poolNomes, 
+                                                    mapa->capacidadePool, novaCapacidade);
+        if (novoPool == NULL) {
+            printf("Erro: Não foi possível alocar memória para os nomes dos territórios!\n");
+            exit(1);
+        }
+        mapa->poolNomes = novoPool;
+        mapa->capacidadePool = novaCapacidade;
+    }
+    
+    int indice = mapa->quantidade++;
+    memcpy(mapa->poolNomes + mapa->tamanhoPool, territorio->nome, tamanhoNome);
+    mapa->nome[indice] = (uint32_t)mapa->tamanhoPool;
+    mapa->tamanhoPool += tamanhoNome;
+    mapa->indiceNomes[posicaoIndice] = (hash & 0xffffffff00000000ULL) | (uint32_t)(indice + 1);
+    
+    mapa->cor[indice] = registrarCor(&mapa->cores, territorio->cor);
+    mapa->corOriginal[indice] = mapa->cor[indice];
+    mapa->tropas[indice] = territorio->tropas;
+    
+    // Incluir o novo território nos agregados
+    contarPosse(mapa, indice, mapa->cor[indice], +1);
+    contarAliados(mapa, indice, +1);
+    
+    if (mapa->partidaLog != 0) {
+        EventoLog evento = {.partida = mapa->partidaLog, .tipo = EVENTO_TERRITORIO, .origem = indice, 
+                            .destino = -1, .deltaOrigem = territorio->tropas, .cor = mapa->cor[indice]};
+        registrarEvento(&evento);
+    }
+    return indice;
+}
+
+// Função para recalcular vizinhos aliados e centros de sequência do mapa inteiro (O(arestas))
+void recalcularAliados(Mapa* mapa) {
+    memset(mapa->agregados.centros, 0, sizeof(mapa->agregados.centros));
+    for (int t = 0; t < mapa->quantidade; t++) {
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        int aliados = 0;
+        for (int i = 0; i < grau; i++) {
+            aliados += mapa->cor[vizinhos[i]] == mapa->cor[t];
+        }
+        mapa->aliados[t] = aliados;
+        if (aliados >= 2) mapa->agregados.centros[mapa->cor[t]]++;
+    }
+}
+
+// Função de comparação de inteiros para qsort
+static int compararInteiros(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Função para construir o grafo de fronteiras (CSR) a partir de pares de territórios
+// (pares[2k] e pares[2k + 1], índices base 0). Cada fronteira vale nos dois sentidos;
+// laços e repetições são descartados. Usa apenas dois vetores, sem alocação por território.
+// Retorna 1 em caso de sucesso e 0 se algum índice for inválido ou faltar memória.
+int construirGrafo(Mapa* mapa, const int* pares, int64_t totalPares) {
+    int quantidade = mapa->quantidade;
+    Arena* arena = mapa->arena;
+    int64_t* inicio = (int64_t*)alocarMemoriaJogo(arena, ((size_t)quantidade + 1) * sizeof(int64_t));
+    int* vizinhos = (int*)alocarMemoriaJogo(arena, (size_t)(2 * totalPares > 0 ? 2 * totalPares : 1) * sizeof(int));
+    if (inicio == NULL || vizinhos == NULL) {
+        liberarMemoriaJogo(arena, vizinhos);
+        liberarMemoriaJogo(arena, inicio);
+        return 0;
+    }
+    
+    // Contar o grau de cada território
+    for (int64_t k = 0; k < totalPares; k++) {
+        int a = pares[2 * k], b = pares[2 * k + 1];
+        if (a < 0 || b < 0 || a >= quantidade || b >= quantidade) {
+            liberarMemoriaJogo(arena, vizinhos);
+            liberarMemoriaJogo(arena, inicio);
+            return 0;
+        }
+        if (a == b) continue;
+        inicio[a + 1]++;
+        inicio[b + 1]++;
+    }
+    for (int t = 0; t < quantidade; t++) {
+        inicio[t + 1] += inicio[t];
+    }
+    
+    // Distribuir as arestas (inicio[t] avança durante o preenchimento e é restaurado depois)
+    for (int64_t k = 0; k < totalPares; k++) {
+        int a = pares[2 * k], b = pares[2 * k + 1];
+        if (a == b) continue;
+        vizinhos[inicio[a]++] = b;
+        vizinhos[inicio[b]++] = a;
+    }
+    for (int t = quantidade; t > 0; t--) {
+        inicio[t] = inicio[t - 1];
+    }
+    inicio[0] = 0;
+    
+    // Ordenar cada lista e remover repetições, compactando no próprio vetor
+    int64_t escrita = 0;
+    for (int t = 0; t < quantidade; t++) {
+        int64_t de = inicio[t], ate = inicio[t + 1];
+        qsort(vizinhos + de, (size_t)(ate - de), sizeof(int), compararInteiros);
+        inicio[t] = escrita;
+        for (int64_t i = de; i < ate; i++) {
+            if (i == de || vizinhos[i] != vizinhos[i - 1]) vizinhos[escrita++] = vizinhos[i];
+        }
+    }
+    inicio[quantidade] = escrita;
+    
+    liberarMemoriaJogo(arena, mapa->inicioVizinhos);
+    liberarMemoriaJogo(arena, mapa->vizinhos);
+    mapa->inicioVizinhos = inicio;
+    mapa->vizinhos = vizinhos;
+    recalcularAliados(mapa);
+    return 1;
+}
+
+// Função para saber se dois territórios fazem fronteira (busca binária na lista, O(log grau)).
+// Sem grafo, todos os territórios fazem fronteira entre si.
+int fazemFronteira(const Mapa* mapa, int a, int b) {
+    if (mapa->vizinhos == NULL) return 1;
+    const int* lista = mapa->vizinhos + mapa->inicioVizinhos[a];
+    int64_t baixo = 0, alto = mapa->inicioVizinhos[a + 1] - mapa->inicioVizinhos[a];
+    while (baixo < alto) {
+        int64_t meio = (baixo + alto) / 2;
+        if (lista[meio] < b) baixo = meio + 1;
+        else alto = meio;
+    }
+    return baixo < mapa->inicioVizinhos[a + 1] - mapa->inicioVizinhos[a] && lista[baixo] == b;
+}
+
+// Função para listar os territórios de uma cor que fazem fronteira com outra cor.
+// 'saida' deve ter espaço para mapa->quantidade índices; retorna quantos foram escritos.
+int listarFronteira(const Mapa* mapa, uint8_t cor, int* saida) {
+    int total = 0;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor) continue;
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        for (int i = 0; i < grau; i++) {
+            if (mapa->cor[vizinhos[i]] != cor) {
+                saida[total++] = t;
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+// Função para rotular as regiões conexas de uma cor (busca em largura).
+// rotulos[t] recebe o número da região de t, ou -1 se t é de outra cor;
+// 'maior' (opcional) recebe o tamanho da maior região.
+// Retorna o número de regiões, ou -1 se faltou memória.
+int rotularRegioes(const Mapa* mapa, uint8_t cor, int* rotulos, int* maior) {
+    int* fila = (int*)malloc((size_t)(mapa->quantidade > 0 ? mapa->quantidade : 1) * sizeof(int));
+    if (fila == NULL) return -1;
+    
+    int regioes = 0;
+    if (maior != NULL) *maior = 0;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        rotulos[t] = -1;
+    }
+    
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor || rotulos[t] >= 0) continue;
+        
+        int inicioFila = 0, fimFila = 0;
+        fila[fimFila++] = t;
+        rotulos[t] = regioes;
+        while (inicioFila < fimFila) {
+            int atual = fila[inicioFila++];
+            int implicitos[2];
+            const int* vizinhos;
+            int grau = listarVizinhos(mapa, atual, &vizinhos, implicitos);
+            for (int i = 0; i < grau; i++) {
+                int vizinho = vizinhos[i];
+                if (mapa->cor[vizinho] == cor && rotulos[vizinho] < 0) {
+                    rotulos[vizinho] = regioes;
+                    fila[fimFila++] = vizinho;
+                }
+            }
+        }
+        if (maior != NULL && fimFila > *maior) *maior = fimFila;
+        regioes++;
+    }
+    
+    free(fila);
+    return regioes;
+}
+
+// Função para alocar memória dinamicamente para os jogadores (na arena, se houver)
+Jogador* alocarJogadores(Arena* arena, int quantidade) {
+    Jogador* jogadores = (Jogador*)alocarMemoriaJogo(arena, (size_t)quantidade * sizeof(Jogador));
+    if (jogadores == NULL) {
+        printf("Erro: Não foi possível alocar memória para os jogadores!\n");
+        exit(1);
+    }
+    printf("Memória alocada com sucesso para %d jogadores.\n", quantidade);
+    return jogadores;
+}
+
+// Função para atribuir missão estratégica a um jogador, resolvendo a cor alvo para um ID
+void atribuirMissaoCorreta(Jogador* jogador, const DefinicaoMissao missoes[], int totalMissoes, 
+                           RegistroCores* cores, GeradorAleatorio* gerador) {
+    int indiceMissao = sortearIntervalo(gerador, totalMissoes);
+    const DefinicaoMissao* definicao = &missoes[indiceMissao];
+    
+    jogador->missao.tipo = definicao->tipo;
+    jogador->missao.parametro = definicao->parametro;
+    jogador->missao.definicao = indiceMissao;
+    jogador->missao.corAlvo = -1;
+    jogador->missao.territorioAlvo = -1;
+    
+    // A cor alvo é registrada já agora, mesmo que nenhum território a use ainda
+    if (definicao->tipo == MISSAO_ELIMINAR_COR) {
+        jogador->missao.corAlvo = registrarCor(cores, definicao->alvo);
+    }
+    jogador->venceu = 0; // Inicializar como não venceu
+}
+
+// Função para registrar no log a missão de cada jogador (o leitor fica com a última de cada um)
+void registrarMissoesLog(const Jogador* jogadores, int numJogadores, const Mapa* mapa) {
+    if (mapa->partidaLog == 0) return;
+    for (int i = 0; i < numJogadores; i++) {
+        EventoLog evento = {.partida = mapa->partidaLog, .tipo = EVENTO_MISSAO, .origem = i, 
+                            .destino = jogadores[i].missao.definicao, .cor = jogadores[i].cor};
+        registrarEvento(&evento);
+    }
+}
+
+// Função para resolver os territórios alvo das missões depois do cadastro do mapa
+void resolverAlvosMissoes(Jogador* jogadores, int numJogadores, const Mapa* mapa) {
+    for (int i = 0; i < numJogadores; i++) {
+        Missao* missao = &jogadores[i].missao;
+        if (missao->tipo != MISSAO_TERRITORIO) continue;
+        
+        missao->territorioAlvo = buscarTerritorio(mapa, missoesPredefinidas[missao->definicao].alvo);
+    }
+    registrarMissoesLog(jogadores, numJogadores, mapa);
+}
+
+// Função para gerar o texto de uma missão a partir da tabela
+void descreverMissao(const Missao* missao, char* texto, size_t tamanho) {
+    const DefinicaoMissao* definicao = &missoesPredefinidas[missao->definicao];
+    if (definicao->alvo != NULL) {
+        snprintf(texto, tamanho, modelosMissao[missao->tipo], definicao->alvo);
+    } else {
+        snprintf(texto, tamanho, modelosMissao[missao->tipo], missao->parametro);
+    }
+}
+
+// Função para exibir a missão de um jogador
+void exibirMissao(const Missao* missao, const char* nomeJogador) {
+    char texto[128];
+    descreverMissao(missao, texto, sizeof(texto));
+    printf("\n🎯 MISSÃO ESTRATÉGICA DE %s:\n", nomeJogador);
+    printf("   \"%s\"\n", texto);
+    printf("   Complete esta missão para vencer o jogo!\n");
+}
+
+// Territórios processados por bloco nas varreduras vetoriais. O que não
+// depende da cor (IDs estendidos para 32 bits, vizinhos iguais, bit da cor
+// original) é preparado uma vez por bloco em buffers que cabem no cache L1;
+// depois cada cor pedida percorre só esses buffers. Assim o mapa é lido da
+// memória uma única vez, qualquer que seja o número de cores.
+#define BLOCO_VARREDURA 1024
+
+// Tropas acima deste valor podem estourar as somas de 32 bits de um bloco
+// (até BLOCO_VARREDURA / 4 parcelas por pista); esses blocos seguem pelo caminho escalar
+#define LIMITE_TROPAS_VETORIAL (1 << 22)
+
+// Peso somado por território da cor: 1 na metade baixa (territórios) e 1 na
+// metade alta quando t-1 e t+1 têm a mesma cor (sequências). Uma pista soma no
+// máximo BLOCO_VARREDURA / 4 pesos por bloco, então as metades não se misturam.
+#define PESO_TERRITORIO 1
+#define PESO_SEQUENCIA (1 << 16)
+
+// Função para zerar os resumos e montar a tabela cor -> posição em 'cores'
+static void prepararVarredura(const uint8_t* cores, int totalCores, int indice[MAX_CORES], ResumoCor* resumos) {
+    for (int c = 0; c < MAX_CORES; c++) indice[c] = -1;
+    for (int k = 0; k < totalCores; k++) {
+        indice[cores[k]] = k;
+        memset(&resumos[k], 0, sizeof(ResumoCor));
+    }
+}
+
+// Função para acumular os territórios [inicio, fim) nos resumos, um a um
+static void acumularTrechoEscalar(const Mapa* mapa, const int indice[MAX_CORES], ResumoCor* resumos,
+                                  int inicio, int fim) {
+    const uint8_t* cor = mapa->cor;
+    int n = mapa->quantidade;
+    for (int t = inicio; t < fim; t++) {
+        int k = indice[cor[t]];
+        if (k < 0) continue;
+        ResumoCor* resumo = &resumos[k];
+        resumo->territorios++;
+        resumo->tropas += mapa->tropas[t];
+        if (mapa->tropas[t] > resumo->maiorTropa) resumo->maiorTropa = mapa->tropas[t];
+        resumo->coresOrigem |= 1u << mapa->corOriginal[t];
+        if (t > 0 && t < n - 1 && cor[t - 1] == cor[t] && cor[t + 1] == cor[t]) resumo->sequencias++;
+    }
+}
+
+// Função para varrer as colunas de forma escalar (referência das versões vetoriais)
+static void varrerColunasEscalar(const Mapa* mapa, const uint8_t* cores, int totalCores, ResumoCor* resumos) {
+    int indice[MAX_CORES];
+    prepararVarredura(cores, totalCores, indice, resumos);
+    acumularTrechoEscalar(mapa, indice, resumos, 0, mapa->quantidade);
+}
+
+#ifdef VARREDURA_X86
+// Função para somar ao resumo as pistas de 32 bits de um bloco vetorial
+static void somarPistas(ResumoCor* resumo, const int32_t* pesos, const int32_t* somas, 
+                        const int32_t* maiores, const int32_t* origens, int pistas) {
+    for (int p = 0; p < pistas; p++) {
+        resumo->territorios += pesos[p] & 0xFFFF;
+        resumo->sequencias += (int)((uint32_t)pesos[p] >> 16);
+        resumo->tropas += somas[p];
+        if (maiores[p] > resumo->maiorTropa) resumo->maiorTropa = maiores[p];
+        resumo->coresOrigem |= (uint32_t)origens[p];
+    }
+}
+
+// Função para carregar 4 IDs de cor (bytes) estendidos para 4 pistas de 32 bits
+static inline __m128i carregarCores4(const uint8_t* origem) {
+    int32_t bytes;
+    memcpy(&bytes, origem, sizeof(bytes));
+    __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+}
+
+// Função para varrer as colunas com SSE2, 4 territórios por instrução.
+// Sem deslocamento variável em SSE2, o bit 1 << cor vem do expoente de um
+// float: (cor + 127) << 23 é 2^cor, e a conversão de 2^31 estoura para
+// 0x80000000, que é justamente 1 << 31.
+static void varrerColunasSSE2(const Mapa* mapa, const uint8_t* cores, int totalCores, ResumoCor* resumos) {
+    __m128i coresBloco[BLOCO_VARREDURA / 4], pesosBloco[BLOCO_VARREDURA / 4], bitsBloco[BLOCO_VARREDURA / 4];
+    int indice[MAX_CORES];
+    int n = mapa->quantidade;
+    prepararVarredura(cores, totalCores, indice, resumos);
+    if (n < 2 + 4) {
+        acumularTrechoEscalar(mapa, indice, resumos, 0, n);
+        return;
+    }
+    // Pistas de [1, fimVetorial) têm vizinhos t-1 e t+1 dentro do mapa
+    int fimVetorial = 1 + ((n - 2) / 4) * 4;
+    acumularTrechoEscalar(mapa, indice, resumos, 0, 1);
+    
+    for (int bloco = 1; bloco < fimVetorial; bloco += BLOCO_VARREDURA) {
+        int fim = bloco + BLOCO_VARREDURA < fimVetorial ? bloco + BLOCO_VARREDURA : fimVetorial;
+        int vetores = (fim - bloco) / 4;
+        const __m128i* tropas = (const __m128i*)&mapa->tropas[bloco];
+        
+        // Preparação do bloco, que também confere os limites das somas
+        __m128i limite = _mm_set1_epi32(LIMITE_TROPAS_VETORIAL);
+        __m128i fora = _mm_setzero_si128();
+        for (int v = 0; v < vetores; v++) {
+            int i = bloco + 4 * v;
+            __m128i atual = carregarCores4(&mapa->cor[i]);
+            __m128i vizinhos = _mm_and_si128(_mm_cmpeq_epi32(carregarCores4(&mapa->cor[i - 1]), atual),
+                                             _mm_cmpeq_epi32(carregarCores4(&mapa->cor[i + 1]), atual));
+            __m128i expoente = _mm_slli_epi32(_mm_add_epi32(carregarCores4(&mapa->corOriginal[i]),
+                                                            _mm_set1_epi32(127)), 23);
+            __m128i quantidade = _mm_loadu_si128(&tropas[v]);
+            coresBloco[v] = atual;
+            pesosBloco[v] = _mm_or_si128(_mm_set1_epi32(PESO_TERRITORIO), 
+                                         _mm_and_si128(vizinhos, _mm_set1_epi32(PESO_SEQUENCIA)));
+            bitsBloco[v] = _mm_cvttps_epi32(_mm_castsi128_ps(expoente));
+            fora = _mm_or_si128(fora, _mm_or_si128(_mm_cmpgt_epi32(quantidade, limite),
+                                                   _mm_cmplt_epi32(quantidade, _mm_setzero_si128())));
+        }
+        if (_mm_movemask_epi8(fora) != 0) {
+            acumularTrechoEscalar(mapa, indice, resumos, bloco, fim);
+            continue;
+        }
+        
+        for (int k = 0; k < totalCores; k++) {
+            __m128i alvo = _mm_set1_epi32(cores[k]);
+            __m128i pesos = _mm_setzero_si128(), soma = _mm_setzero_si128();
+            __m128i maior = _mm_setzero_si128(), origem = _mm_setzero_si128();
+            for (int v = 0; v < vetores; v++) {
+                __m128i mascara = _mm_cmpeq_epi32(coresBloco[v], alvo);
+                __m128i quantidade = _mm_and_si128(mascara, _mm_loadu_si128(&tropas[v]));
+                __m128i maiorQue = _mm_cmpgt_epi32(quantidade, maior);
+                pesos = _mm_add_epi32(pesos, _mm_and_si128(mascara, pesosBloco[v]));
+                soma = _mm_add_epi32(soma, quantidade);
+                maior = _mm_or_si128(_mm_and_si128(maiorQue, quantidade), _mm_andnot_si128(maiorQue, maior));
+                origem = _mm_or_si128(origem, _mm_and_si128(mascara, bitsBloco[v]));
+            }
+            int32_t pistas[4][4];
+            _mm_storeu_si128((__m128i*)pistas[0], pesos);
+            _mm_storeu_si128((__m128i*)pistas[1], soma);
+            _mm_storeu_si128((__m128i*)pistas[2], maior);
+            _mm_storeu_si128((__m128i*)pistas[3], origem);
+            somarPistas(&resumos[k], pistas[0], pistas[1], pistas[2], pistas[3], 4);
+        }
+    }
+    acumularTrechoEscalar(mapa, indice, resumos, fimVetorial, n);
+}
+
+// Função para carregar 8 IDs de cor (bytes) estendidos para 8 pistas de 32 bits
+__attribute__((target("avx2")))
+static inline __m256i carregarCores8(const uint8_t* origem) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)origem));
+}
+
+// Função para varrer as colunas com AVX2, 8 territórios por instrução
+__attribute__((target("avx2")))
+static void varrerColunasAVX2(const Mapa* mapa, const uint8_t* cores, int totalCores, ResumoCor* resumos) {
+    __m256i coresBloco[BLOCO_VARREDURA / 8], pesosBloco[BLOCO_VARREDURA / 8], bitsBloco[BLOCO_VARREDURA / 8];
+    int indice[MAX_CORES];
+    int n = mapa->quantidade;
+    prepararVarredura(cores, totalCores, indice, resumos);
+    if (n < 2 + 8) {
+        acumularTrechoEscalar(mapa, indice, resumos, 0, n);
+        return;
+    }
+    int fimVetorial = 1 + ((n - 2) / 8) * 8;
+    acumularTrechoEscalar(mapa, indice, resumos, 0, 1);
+    
+    for (int bloco = 1; bloco < fimVetorial; bloco += BLOCO_VARREDURA) {
+        int fim = bloco + BLOCO_VARREDURA < fimVetorial ? bloco + BLOCO_VARREDURA : fimVetorial;
+        int vetores = (fim - bloco) / 8;
+        const __m256i* tropas = (const __m256i*)&mapa->tropas[bloco];
+        
+        __m256i limite = _mm256_set1_epi32(LIMITE_TROPAS_VETORIAL);
+        __m256i fora = _mm256_setzero_si256();
+        for (int v = 0; v < vetores; v++) {
+            int i = bloco + 8 * v;
+            __m256i atual = carregarCores8(&mapa->cor[i]);
+            __m256i vizinhos = _mm256_and_si256(_mm256_cmpeq_epi32(carregarCores8(&mapa->cor[i - 1]), atual),
+                                                _mm256_cmpeq_epi32(carregarCores8(&mapa->cor[i + 1]), atual));
+            __m256i quantidade = _mm256_loadu_si256(&tropas[v]);
+            coresBloco[v] = atual;
+            pesosBloco[v] = _mm256_or_si256(_mm256_set1_epi32(PESO_TERRITORIO), 
+                                            _mm256_and_si256(vizinhos, _mm256_set1_epi32(PESO_SEQUENCIA)));
+            bitsBloco[v] = _mm256_sllv_epi32(_mm256_set1_epi32(1), carregarCores8(&mapa->corOriginal[i]));
+            fora = _mm256_or_si256(fora, _mm256_or_si256(_mm256_cmpgt_epi32(quantidade, limite),
+                                                         _mm256_cmpgt_epi32(_mm256_setzero_si256(), quantidade)));
+        }
+        if (!_mm256_testz_si256(fora, fora)) {
+            acumularTrechoEscalar(mapa, indice, resumos, bloco, fim);
+            continue;
+        }
+        
+        for (int k = 0; k < totalCores; k++) {
+            __m256i alvo = _mm256_set1_epi32(cores[k]);
+            __m256i pesos = _mm256_setzero_si256(), soma = _mm256_setzero_si256();
+            __m256i maior = _mm256_setzero_si256(), origem = _mm256_setzero_si256();
+            for (int v = 0; v < vetores; v++) {
+                __m256i mascara = _mm256_cmpeq_epi32(coresBloco[v], alvo);
+                __m256i quantidade = _mm256_and_si256(mascara, _mm256_loadu_si256(&tropas[v]));
+                pesos = _mm256_add_epi32(pesos, _mm256_and_si256(mascara, pesosBloco[v]));
+                soma = _mm256_add_epi32(soma, quantidade);
+                maior = _mm256_max_epi32(maior, quantidade);
+                origem = _mm256_or_si256(origem, _mm256_and_si256(mascara, bitsBloco[v]));
+            }
+            int32_t pistas[4][8];
+            _mm256_storeu_si256((__m256i*)pistas[0], pesos);
+            _mm256_storeu_si256((__m256i*)pistas[1], soma);
+            _mm256_storeu_si256((__m256i*)pistas[2], maior);
+            _mm256_storeu_si256((__m256i*)pistas[3], origem);
+            somarPistas(&resumos[k], pistas[0], pistas[1], pistas[2], pistas[3], 8);
+        }
+    }
+    acumularTrechoEscalar(mapa, indice, resumos, fimVetorial, n);
+}
+#endif
+
+// Versões da varredura de colunas, da mais simples para a mais rápida
+typedef void (*FuncaoVarredura)(const Mapa*, const uint8_t*, int, ResumoCor*);
+
+typedef struct {
+    const char* nome;
+    FuncaoVarredura varrer;
+} VersaoVarredura;
+
+const VersaoVarredura versoesVarredura[] = {
+    {"escalar", varrerColunasEscalar},
+#ifdef VARREDURA_X86
+    {"sse2", varrerColunasSSE2},
+    {"avx2", varrerColunasAVX2},
+#endif
+};
+
+#define TOTAL_VERSOES_VARREDURA ((int)(sizeof(versoesVarredura) / sizeof(versoesVarredura[0])))
+
+// Função para saber se o processador atual executa uma versão da varredura
+int versaoVarreduraSuportada(int versao) {
+#ifdef VARREDURA_X86
+    if (versoesVarredura[versao].varrer == varrerColunasAVX2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return versao >= 0 && versao < TOTAL_VERSOES_VARREDURA;
+}
+
+static const VersaoVarredura* versaoVarreduraEscolhida = NULL;
+static pthread_once_t versaoVarreduraPronta = PTHREAD_ONCE_INIT;
+
+// Função para escolher, uma única vez, a versão mais rápida suportada
+static void escolherVersaoVarredura(void) {
+    int escolhida = 0;
+    for (int v = 0; v < TOTAL_VERSOES_VARREDURA; v++) {
+        if (versaoVarreduraSuportada(v)) escolhida = v;
+    }
+    versaoVarreduraEscolhida = &versoesVarredura[escolhida];
+}
+
+// Função para obter a versão da varredura usada por varrerColunas
+const VersaoVarredura* obterVersaoVarredura(void) {
+    pthread_once(&versaoVarreduraPronta, escolherVersaoVarredura);
+    return versaoVarreduraEscolhida;
+}
+
+// Função para recalcular, em uma única passada pelas colunas, o resumo de
+// cada cor de 'cores' (IDs distintos), sem depender dos agregados do mapa
+void varrerColunas(const Mapa* mapa, const uint8_t* cores, int totalCores, ResumoCor* resumos) {
+    obterVersaoVarredura()->varrer(mapa, cores, totalCores, resumos);
+}
+
+// Missão: N territórios consecutivos (conectados por fronteiras) da mesma cor.
+// Para N = 3, basta um território com dois vizinhos aliados (agregado em O(1));
+// para outros valores, procura uma região conexa com pelo menos N territórios.
+static int verificarSequencia(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    if (missao->parametro == TAMANHO_SEQUENCIA_MISSAO) {
+        return mapa->agregados.centros[corJogador] > 0;
+    }
+    int* rotulos = (int*)malloc((size_t)(mapa->quantidade > 0 ? mapa->quantidade : 1) * sizeof(int));
+    int maior = 0;
+    if (rotulos == NULL) return 0;
+    rotularRegioes(mapa, corJogador, rotulos, &maior);
+    free(rotulos);
+    return maior >= missao->parametro;
+}
+
+// Missão: nenhuma tropa da cor alvo no mapa
+static int verificarEliminarCor(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    (void)corJogador;
+    return missao->corAlvo < 0 || mapa->agregados.territorios[missao->corAlvo] == 0;
+}
+
+// Missão: controlar pelo menos N territórios
+static int verificarControlar(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    return mapa->agregados.territorios[corJogador] >= missao->parametro;
+}
+
+// Missão: mais de N tropas em um único território
+static int verificarAcumular(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    if (missao->parametro == LIMITE_TROPAS_MISSAO) {
+        return mapa->agregados.acimaLimite[corJogador] > 0;
+    }
+    ResumoCor resumo;
+    varrerColunas(mapa, &corJogador, 1, &resumo);
+    return resumo.maiorTropa > missao->parametro;
+}
+
+// Missão: territórios de pelo menos N cores originais diferentes
+static int verificarCoresDiferentes(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    return mapa->agregados.coresOrigem[corJogador] >= missao->parametro;
+}
+
+// Missão: mais de N tropas no total
+static int verificarTotalTropas(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    return mapa->agregados.tropas[corJogador] > missao->parametro;
+}
+
+// Missão: controlar o território alvo
+static int verificarTerritorio(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    return missao->territorioAlvo >= 0 && mapa->cor[missao->territorioAlvo] == corJogador;
+}
+
+// Tabela de verificação, indexada pelo tipo da missão
+typedef int (*VerificadorMissao)(const Missao*, const Mapa*, uint8_t);
+
+const VerificadorMissao verificadoresMissao[TOTAL_TIPOS_MISSAO] = {
+    verificarSequencia,
+    verificarEliminarCor,
+    verificarControlar,
+    verificarAcumular,
+    verificarCoresDiferentes,
+    verificarTotalTropas,
+    verificarTerritorio
+};
+
+// Função para verificar se uma missão foi cumprida
+int verificarMissao(const Missao* missao, const Mapa* mapa, uint8_t corJogador) {
+    return verificadoresMissao[missao->tipo](missao, mapa, corJogador);
+}
+
+// Função para descobrir, sem imprimir nada, se algum jogador cumpriu a missão
+int encontrarVencedor(Jogador* jogadores, int numJogadores, const Mapa* mapa) {
+    int vencedor = -1; // Nenhum vencedor ainda
+    INICIAR_MEDICAO(LATENCIA_VITORIA);
+    CONTAR_METRICA(CONTADOR_VERIFICACOES_VITORIA, 1);
+    for (int i = 0; i < numJogadores; i++) {
+        if (!jogadores[i].venceu && verificarMissao(&jogadores[i].missao, mapa, jogadores[i].cor)) {
+            jogadores[i].venceu = 1;
+            vencedor = i; // Índice do vencedor
+            break;
+        }
+    }
+    ENCERRAR_MEDICAO(LATENCIA_VITORIA);
+    return vencedor;
+}
+
+// Função para avaliar, em uma única passada pelas colunas e pelo grafo de
+// fronteiras, o que os resumos não cobrem: as cores com um território de dois
+// vizinhos da mesma cor (marcadas em 'centros'; só pedidas com grafo, já que
+// sem ele a vizinhança é a ordem das colunas) e o dono de cada território alvo,
+// pedido (por posição em missoesPredefinidas), achado comparando os nomes do
+// pool, sem o índice de nomes
+static void varrerFronteirasEAlvos(const Mapa* mapa, const uint8_t querCentro[MAX_CORES], 
+                                   uint8_t centros[MAX_CORES], const uint8_t querAlvo[TOTAL_MISSOES], 
+                                   int donosAlvo[TOTAL_MISSOES]) {
+    int alvosPendentes = 0;
+    for (int k = 0; k < TOTAL_MISSOES; k++) {
+        donosAlvo[k] = -1;
+        alvosPendentes += querAlvo[k];
+    }
+    for (int t = 0; t < mapa->quantidade; t++) {
+        uint8_t cor = mapa->cor[t];
+        if (querCentro[cor] && !centros[cor]) {
+            int iguais = 0;
+            for (int64_t v = mapa->inicioVizinhos[t]; v < mapa->inicioVizinhos[t + 1] && iguais < 2; v++) {
+                iguais += mapa->cor[mapa->vizinhos[v]] == cor;
+            }
+            centros[cor] = iguais >= 2;
+        }
+        if (alvosPendentes > 0) {
+            const char* nome = nomeTerritorio(mapa, t);
+            for (int k = 0; k < TOTAL_MISSOES; k++) {
+                if (querAlvo[k] && donosAlvo[k] < 0 && strcmp(nome, missoesPredefinidas[k].alvo) == 0) {
+                    donosAlvo[k] = cor;
+                    alvosPendentes--;
+                }
+            }
+        }
+    }
+}
+
+// Função para descobrir o vencedor recalculando tudo a partir das colunas e do
+// grafo, sem ler os agregados nem o índice de nomes (serve de auditoria deles):
+// uma varredura resume as cores de todos os jogadores e as cores alvo, e uma
+// segunda passada, só quando alguma missão precisa, conta os vizinhos aliados
+// pelo grafo e procura pelo nome os territórios alvo. Sequências de outro
+// tamanho seguem pela busca de regiões, que também só lê colunas e grafo.
+int encontrarVencedorVarredura(Jogador* jogadores, int numJogadores, const Mapa* mapa) {
+    CONTAR_METRICA(CONTADOR_VERIFICACOES_VITORIA, 1);
+    uint8_t cores[MAX_CORES];
+    int posicao[MAX_CORES];
+    int totalCores = 0;
+    for (int c = 0; c < MAX_CORES; c++) posicao[c] = -1;
+    for (int i = 0; i < numJogadores; i++) {
+        int candidatas[2] = {jogadores[i].cor, -1};
+        if (jogadores[i].missao.tipo == MISSAO_ELIMINAR_COR) candidatas[1] = jogadores[i].missao.corAlvo;
+        for (int j = 0; j < 2; j++) {
+            if (candidatas[j] >= 0 && posicao[candidatas[j]] < 0) {
+                posicao[candidatas[j]] = totalCores;
+                cores[totalCores++] = (uint8_t)candidatas[j];
+            }
+        }
+    }
+    
+    ResumoCor resumos[MAX_CORES];
+    varrerColunas(mapa, cores, totalCores, resumos);
+    
+    // Centros pelo grafo e territórios alvo pelo nome, em uma passada extra
+    uint8_t querCentro[MAX_CORES] = {0}, centros[MAX_CORES] = {0}, querAlvo[TOTAL_MISSOES] = {0};
+    int donosAlvo[TOTAL_MISSOES];
+    int precisaPassada = 0;
+    for (int i = 0; i < numJogadores; i++) {
+        const Missao* missao = &jogadores[i].missao;
+        if (jogadores[i].venceu) continue;
+        if (missao->tipo == MISSAO_SEQUENCIA && missao->parametro == TAMANHO_SEQUENCIA_MISSAO && 
+            mapa->vizinhos != NULL) {
+            querCentro[jogadores[i].cor] = 1;
+            precisaPassada = 1;
+        } else if (missao->tipo == MISSAO_TERRITORIO) {
+            querAlvo[missao->definicao] = 1;
+            precisaPassada = 1;
+        }
+    }
+    if (precisaPassada) varrerFronteirasEAlvos(mapa, querCentro, centros, querAlvo, donosAlvo);
+    
+    for (int i = 0; i < numJogadores; i++) {
+        const Missao* missao = &jogadores[i].missao;
+        const ResumoCor* resumo = &resumos[posicao[jogadores[i].cor]];
+        int cumprida;
+        if (jogadores[i].venceu) continue;
+        switch (missao->tipo) {
+            case MISSAO_SEQUENCIA:
+                if (missao->parametro != TAMANHO_SEQUENCIA_MISSAO) {
+                    cumprida = verificarSequencia(missao, mapa, jogadores[i].cor);
+                } else if (mapa->vizinhos != NULL) {
+                    cumprida = centros[jogadores[i].cor];
+                } else {
+                    cumprida = resumo->sequencias > 0;
+                }
+                break;
+            case MISSAO_ELIMINAR_COR:
+                cumprida = missao->corAlvo < 0 || resumos[posicao[missao->corAlvo]].territorios == 0;
+                break;
+            case MISSAO_CONTROLAR:
+                cumprida = resumo->territorios >= missao->parametro;
+                break;
+            case MISSAO_ACUMULAR:
+                cumprida = resumo->maiorTropa > missao->parametro;
+                break;
+            case MISSAO_CORES_DIFERENTES:
+                cumprida = __builtin_popcount(resumo->coresOrigem) >= missao->parametro;
+                break;
+            case MISSAO_TOTAL_TROPAS:
+                cumprida = resumo->tropas > missao->parametro;
+                break;
+            default:
+                cumprida = donosAlvo[missao->definicao] == jogadores[i].cor;
+                break;
+        }
+        if (cumprida) {
+            jogadores[i].venceu = 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Função para verificar se algum jogador venceu
+int verificarVencedor(Jogador* jogadores, int numJogadores, const Mapa* mapa) {
+    int vencedor = encontrarVencedor(jogadores, numJogadores, mapa);
+    if (vencedor >= 0) {
+        char texto[128];
+        descreverMissao(&jogadores[vencedor].missao, texto, sizeof(texto));
+        printf("\n🏆 TEMOS UM VENCEDOR! 🏆\n");
+        printf("Jogador %s (%s) completou sua missão!\n", 
+               jogadores[vencedor].nome, nomeCor(&mapa->cores, jogadores[vencedor].cor));
+        printf("Missão: \"%s\"\n", texto);
+    }
+    return vencedor;
+}
+
+// Função para liberar as colunas de um mapa, sem I/O.
+// Em uma arena as colunas só são descartadas quando a arena é reiniciada.
+void liberarMapa(Mapa* mapa) {
+    Arena* arena = mapa->arena;
+    if (mapa->mapeamento != NULL) {
+        // As colunas apontam para dentro do snapshot mapeado
+        munmap(mapa->mapeamento, mapa->tamanhoMapeamento);
+    } else if (arena == NULL) {
+        free(mapa->cor);
+        free(mapa->corOriginal);
+        free(mapa->tropas);
+        free(mapa->nome);
+        free(mapa->aliados);
+        free(mapa->indiceNomes);
+        free(mapa->poolNomes);
+        free(mapa->inicioVizinhos);
+        free(mapa->vizinhos);
+    }
+    inicializarMapa(mapa);
+    mapa->arena = arena;
+}
+
+// Função para liberar a memória alocada dinamicamente
+void liberarMemoria(Mapa* mapa, Jogador* jogadores, int numJogadores) {
+    // Liberar memória das colunas dos territórios
+    if (mapa->cor != NULL || mapa->mapeamento != NULL) {
+        liberarMapa(mapa);
+        printf("Memória dos territórios liberada com sucesso.\n");
+    }
+    
+    // Liberar memória dos jogadores (as missões ficam dentro de cada Jogador)
+    (void)numJogadores;
+    if (jogadores != NULL) {
+        liberarMemoriaJogo(mapa->arena, jogadores);
+    }
+}
+
+// Função para iniciar uma partida vazia com a semente informada
+// (fora de arena; para uma partida em arena veja criarJogoNaArena)
+void iniciarJogo(Jogo* jogo, uint64_t semente) {
+    memset(jogo, 0, sizeof(Jogo));
+    inicializarMapa(&jogo->mapa);
+    inicializarGerador(&jogo->gerador, semente, 0);
+    jogo->semente = semente;
+    jogo->vencedor = -1;
+    jogo->mapa.partidaLog = novaPartidaLog();
+    if (jogo->mapa.partidaLog != 0) {
+        EventoLog evento = {.partida = jogo->mapa.partidaLog, .tipo = EVENTO_PARTIDA, 
+                            .origem = -1, .destino = -1, .extra = (uint32_t)semente};
+        registrarEvento(&evento);
+    }
+}
+
+// Função para incluir um jogador na partida e sortear sua missão, sem I/O.
+// Retorna o jogador criado ou NULL se faltou memória.
+Jogador* adicionarJogador(Jogo* jogo, const char* nome, const char* cor) {
+    if (jogo->numJogadores >= jogo->capacidadeJogadores) {
+        int novaCapacidade = jogo->capacidadeJogadores > 0 ? jogo->capacidadeJogadores * 2 : 4;
+        Jogador* novos = (Jogador*)realocarMemoriaJogo(jogo->mapa.arena, jogo->jogadores, 
+                                                       jogo->capacidadeJogadores * sizeof(Jogador), 
+                                                       novaCapacidade * sizeof(Jogador));
+        if (novos == NULL) return NULL;
+        jogo->jogadores = novos;
+        jogo->capacidadeJogadores = novaCapacidade;
+    }
+    
+    Jogador* jogador = &jogo->jogadores[jogo->numJogadores++];
+    memset(jogador, 0, sizeof(Jogador));
+    snprintf(jogador->nome, sizeof(jogador->nome), "%s", nome);
+    jogador->cor = registrarCor(&jogo->mapa.cores, cor);
+    atribuirMissaoCorreta(jogador, missoesPredefinidas, TOTAL_MISSOES, 
+                          &jogo->mapa.cores, &jogo->gerador);
+    return jogador;
+}
+
+// Função para registrar no log o fim de uma partida, com ou sem vencedor
+void registrarFimLog(const Jogo* jogo) {
+    if (jogo->mapa.partidaLog == 0) return;
+    EventoLog evento = {.partida = jogo->mapa.partidaLog, .tipo = EVENTO_FIM, .origem = jogo->vencedor, 
+                        .destino = jogo->vencedor >= 0 ? jogo->jogadores[jogo->vencedor].missao.definicao : -1,
+                        .extra = jogo->ataques > UINT32_MAX ? UINT32_MAX : (uint32_t)jogo->ataques,
+                        .cor = jogo->vencedor >= 0 ? jogo->jogadores[jogo->vencedor].cor : 0};
+    registrarEvento(&evento);
+}
+
+// Função para liberar tudo o que uma partida alocou, sem I/O
+void encerrarJogo(Jogo* jogo) {
+    liberarMapa(&jogo->mapa);
+    liberarMemoriaJogo(jogo->mapa.arena, jogo->jogadores);
+    jogo->jogadores = NULL;
+    jogo->numJogadores = 0;
+    jogo->capacidadeJogadores = 0;
+}
+
+// Função para começar uma partida dentro de uma arena: descarta o que havia
+// nela (O(1)) e coloca o Jogo no início, seguido de tudo o que ele alocar.
+// Retorna o jogo ou NULL se a arena não tem espaço nem para o Jogo.
+Jogo* criarJogoNaArena(Arena* arena, uint64_t semente) {
+    reiniciarArena(arena);
+    Jogo* jogo = (Jogo*)alocarArena(arena, sizeof(Jogo));
+    if (jogo == NULL) return NULL;
+    iniciarJogo(jogo, semente);
+    jogo->mapa.arena = arena;
+    return jogo;
+}
+
+// Função auxiliar para mover um ponteiro que aponta para dentro da arena de origem
+static inline void* rebasearPonteiro(void* ponteiro, const Arena* origem, const Arena* destino) {
+    if (ponteiro == NULL) return NULL;
+    return destino->inicio + ((char*)ponteiro - origem->inicio);
+}
+
+// Função para clonar uma partida em outra arena (para buscas do tipo "e se?"):
+// um único memcpy da arena de origem seguido do ajuste dos ponteiros internos.
+// O destino é reiniciado. Retorna o clone ou NULL se a partida não está em uma
+// arena (ou vem de um snapshot mapeado) ou se o destino é pequeno demais.
+Jogo* clonarJogo(const Jogo* jogo, Arena* destino) {
+    const Arena* origem = jogo->mapa.arena;
+    if (origem == NULL || jogo->mapa.mapeamento != NULL || origem->usado > destino->reservado) return NULL;
+    
+    memcpy(destino->inicio, origem->inicio, origem->usado);
+    destino->usado = origem->usado;
+    destino->ultimo = origem->ultimo;
+    
+    Jogo* clone = (Jogo*)rebasearPonteiro((void*)jogo, origem, destino);
+    Mapa* mapa = &clone->mapa;
+    clone->jogadores = (Jogador*)rebasearPonteiro(clone->jogadores, origem, destino);
+    mapa->cor = (uint8_t*)rebasearPonteiro(mapa->cor, origem, destino);
+    mapa->corOriginal = (uint8_t*)rebasearPonteiro(mapa->corOriginal, origem, destino);
+    mapa->tropas = (int*)rebasearPonteiro(mapa->tropas, origem, destino);
+    mapa->nome = (uint32_t*)rebasearPonteiro(mapa->nome, origem, destino);
+    mapa->aliados = (int*)rebasearPonteiro(mapa->aliados, origem, destino);
+    mapa->poolNomes = (char*)rebasearPonteiro(mapa->poolNomes, origem, destino);
+    mapa->indiceNomes = (uint64_t*)rebasearPonteiro(mapa->indiceNomes, origem, destino);
+    mapa->inicioVizinhos = (int64_t*)rebasearPonteiro(mapa->inicioVizinhos, origem, destino);
+    mapa->vizinhos = (int*)rebasearPonteiro(mapa->vizinhos, origem, destino);
+    mapa->arena = destino;
+    mapa->diario = NULL; // O diário pertence à partida original
+    mapa->partidaLog = 0; // Jogadas hipotéticas não vão para o log
+    return clone;
+}
+
+// Função para cadastrar um jogador
+void cadastrarJogador(Jogador* jogador, int indice, RegistroCores* cores, GeradorAleatorio* gerador) {
+    char cor[10];
+    
+    printf("\n=== CADASTRO DO JOGADOR %d ===\n", indice + 1);
+    
+    printf("Digite o nome do jogador: ");
+    scanf(" %19s", jogador->nome);
+    
+    printf("Digite a cor do exército: ");
+    scanf(" %9s", cor);
+    jogador->cor = registrarCor(cores, cor);
+    
+    // Atribuir missão estratégica
+    atribuirMissaoCorreta(jogador, missoesPredefinidas, TOTAL_MISSOES, cores, gerador);
+    
+    printf("Jogador '%s' cadastrado com sucesso!\n", jogador->nome);
+    exibirMissao(&jogador->missao, jogador->nome);
+}
+
+// Função para cadastrar um território lido do terminal no mapa
+void cadastrarTerritorio(Mapa* mapa, int indice) {
+    Territorio territorio;
+    
+    printf("\n=== CADASTRO DO TERRITÓRIO %d ===\n", indice + 1);
+    
+    // Entrada do nome do território (nomes não podem se repetir)
+    do {
+        printf("Digite o nome do território: ");
+        scanf(" %29s", territorio.nome);
+        if (buscarTerritorio(mapa, territorio.nome) >= 0) {
+            printf("Erro: Já existe um território chamado '%s'!\n", territorio.nome);
+        }
+    } while (buscarTerritorio(mapa, territorio.nome) >= 0);
+    
+    // Entrada da cor do exército
+    printf("Digite a cor do exército: ");
+    scanf(" %9s", territorio.cor);
+    
+    // Entrada da quantidade de tropas (mínimo 1 para poder atacar)
+    do {
+        printf("Digite o número de tropas (mínimo 1): ");
+        scanf("%d", &territorio.tropas);
+        if (territorio.tropas < 1) {
+            printf("Erro: Um território deve ter pelo menos 1 tropa!\n");
+        }
+    } while (territorio.tropas < 1);
+    
+    adicionarTerritorio(mapa, &territorio);
+    printf("Território '%s' cadastrado com sucesso!\n", territorio.nome);
+}
+
+// Buffer de saída reutilizável: o texto é montado em memória e escrito com
+// uma única chamada write() por página
+#define TAMANHO_BUFFER_SAIDA (1 << 16)
+#define TERRITORIOS_POR_PAGINA 50
+
+typedef struct {
+    char dados[TAMANHO_BUFFER_SAIDA];
+    size_t usado;
+    int descritor;          // Destino do write() (STDOUT_FILENO no terminal)
+    FILE* arquivo;          // Se definido, recebe o texto no lugar do descritor
+} BufferSaida;
+
+// Modos de exibição do mapa
+typedef enum {
+    EXIBICAO_DETALHADA,     // Um bloco de linhas por território
+    EXIBICAO_TABELA         // Uma linha por território
+} ModoExibicao;
+
+// Opções de exibição: paginação e filtros
+typedef struct {
+    ModoExibicao modo;
+    int pagina;             // Página a exibir (base 1); 0 exibe todas
+    int tamanhoPagina;
+    int filtroCor;          // ID da cor a exibir (-1 = todas)
+    int tropasMinimas;      // Exibe só territórios com pelo menos essas tropas
+} OpcoesExibicao;
+
+// Função para escrever o conteúdo do buffer no descritor e esvaziá-lo
+void descarregarBuffer(BufferSaida* buffer) {
+    size_t escrito = 0;
+    if (buffer->arquivo != NULL) {
+        fwrite(buffer->dados, 1, buffer->usado, buffer->arquivo);
+        buffer->usado = 0;
+        return;
+    }
+    fflush(stdout); // Preservar a ordem em relação ao printf
+    while (escrito < buffer->usado) {
+        ssize_t n = write(buffer->descritor, buffer->dados + escrito, buffer->usado - escrito);
+        if (n <= 0) break;
+        escrito += (size_t)n;
+    }
+    buffer->usado = 0;
+}
+
+// Função para acrescentar texto ao buffer (descarrega se estiver cheio)
+void anexarTexto(BufferSaida* buffer, const char* texto, size_t tamanho) {
+    if (buffer->usado + tamanho > sizeof(buffer->dados)) {
+        descarregarBuffer(buffer);
+        if (tamanho > sizeof(buffer->dados)) tamanho = sizeof(buffer->dados);
+    }
+    memcpy(buffer->dados + buffer->usado, texto, tamanho);
+    buffer->usado += tamanho;
+}
+
+// Função para acrescentar uma string terminada em \0 ao buffer
+static inline void anexarString(BufferSaida* buffer, const char* texto) {
+    anexarTexto(buffer, texto, strlen(texto));
+}
+
+// Função para acrescentar texto alinhado à esquerda em uma coluna de 'largura' caracteres
+void anexarColuna(BufferSaida* buffer, const char* texto, int largura) {
+    static const char espacos[32] = "                               ";
+    size_t tamanho = strlen(texto);
+    anexarTexto(buffer, texto, tamanho);
+    if ((int)tamanho < largura) anexarTexto(buffer, espacos, (size_t)(largura - (int)tamanho));
+}
+
+// Função para acrescentar um inteiro ao buffer, alinhado à direita em 'largura' caracteres
+void anexarInteiro(BufferSaida* buffer, long long valor, int largura) {
+    char digitos[24];
+    int posicao = sizeof(digitos);
+    unsigned long long absoluto = valor < 0 ? 0ULL - (unsigned long long)valor : (unsigned long long)valor;
+    
+    do {
+        digitos[--posicao] = (char)('0' + absoluto % 10);
+        absoluto /= 10;
+    } while (absoluto > 0);
+    if (valor < 0) digitos[--posicao] = '-';
+    while ((int)sizeof(digitos) - posicao < largura && posicao > 0) digitos[--posicao] = ' ';
+    anexarTexto(buffer, digitos + posicao, sizeof(digitos) - posicao);
+}
+
+// Função para formatar um território no modo detalhado
+static void renderizarTerritorioDetalhado(BufferSaida* buffer, const Mapa* mapa, int indice) {
+    anexarString(buffer, "Território ");
+    anexarInteiro(buffer, indice + 1, 0);
+    anexarString(buffer, ":\n  Nome: ");
+    anexarString(buffer, nomeTerritorio(mapa, indice));
+    anexarString(buffer, "\n  Cor do Exército: ");
+    anexarString(buffer, nomeCor(&mapa->cores, mapa->cor[indice]));
+    anexarString(buffer, "\n  Tropas: ");
+    anexarInteiro(buffer, mapa->tropas[indice], 0);
+    anexarString(buffer, "\n  ---------------------------\n");
+}
+
+// Função para formatar um território no modo tabela (uma linha)
+static void renderizarTerritorioTabela(BufferSaida* buffer, const Mapa* mapa, int indice) {
+    anexarInteiro(buffer, indice + 1, 8);
+    anexarString(buffer, "  ");
+    anexarColuna(buffer, nomeTerritorio(mapa, indice), 30);
+    anexarColuna(buffer, nomeCor(&mapa->cores, mapa->cor[indice]), 10);
+    anexarInteiro(buffer, mapa->tropas[indice], 8);
+    anexarString(buffer, "\n");
+}
+
+// Função para montar e escrever a exibição do mapa conforme as opções.
+// Retorna quantos territórios passaram pelos filtros.
+int renderizarMapa(const Mapa* mapa, const OpcoesExibicao* opcoes, BufferSaida* buffer) {
+    int tamanhoPagina = opcoes->tamanhoPagina > 0 ? opcoes->tamanhoPagina : TERRITORIOS_POR_PAGINA;
+    // Em long long: a página vem do usuário e (pagina - 1) * tamanhoPagina pode estourar um int
+    long long primeiro = opcoes->pagina > 0 ? (long long)(opcoes->pagina - 1) * tamanhoPagina : 0;
+    long long limite = opcoes->pagina > 0 ? primeiro + tamanhoPagina : mapa->quantidade;
+    int filtrados = 0;
+    INICIAR_MEDICAO(LATENCIA_RENDERIZACAO);
+    CONTAR_METRICA(CONTADOR_RENDERIZACOES, 1);
+    
+    anexarString(buffer, "\n=== MAPA DE TERRITÓRIOS ===\nTotal de territórios: ");
+    anexarInteiro(buffer, mapa->quantidade, 0);
+    anexarString(buffer, "\n\n");
+    if (opcoes->modo == EXIBICAO_TABELA) {
+        anexarString(buffer, "       #  Nome                          Cor         Tropas\n");
+    }
+    
+    for (int i = 0; i < mapa->quantidade; i++) {
+        if (opcoes->filtroCor >= 0 && mapa->cor[i] != opcoes->filtroCor) continue;
+        if (mapa->tropas[i] < opcoes->tropasMinimas) continue;
+        
+        if (filtrados >= primeiro && filtrados < limite) {
+            if (opcoes->modo == EXIBICAO_TABELA) {
+                renderizarTerritorioTabela(buffer, mapa, i);
+            } else {
+                renderizarTerritorioDetalhado(buffer, mapa, i);
+            }
+        }
+        filtrados++;
+    }
+    
+    // Rodapé apenas quando algo ficou de fora da exibição
+    if (filtrados != mapa->quantidade || opcoes->pagina > 0) {
+        long long paginas = ((long long)filtrados + tamanhoPagina - 1) / tamanhoPagina;
+        long long exibidos = filtrados - primeiro;
+        if (exibidos < 0) exibidos = 0;
+        if (exibidos > limite - primeiro) exibidos = limite - primeiro;
+        anexarString(buffer, "\nExibindo ");
+        anexarInteiro(buffer, exibidos, 0);
+        anexarString(buffer, " de ");
+        anexarInteiro(buffer, filtrados, 0);
+        anexarString(buffer, " territórios filtrados");
+        if (opcoes->pagina > 0) {
+            anexarString(buffer, " (página ");
+            anexarInteiro(buffer, opcoes->pagina, 0);
+            anexarString(buffer, " de ");
+            anexarInteiro(buffer, paginas > 0 ? paginas : 1, 0);
+            anexarString(buffer, ")");
+        }
+        anexarString(buffer, "\n");
+    }
+    
+    descarregarBuffer(buffer);
+    ENCERRAR_MEDICAO(LATENCIA_RENDERIZACAO);
+    return filtrados;
+}
+
+// Buffer compartilhado pelas exibições do terminal (evita alocar a cada chamada)
+static BufferSaida bufferTerminal = {.usado = 0, .descritor = STDOUT_FILENO};
+
+// Função para exibir todos os territórios cadastrados. Mapas grandes são
+// exibidos como tabela, apenas a primeira página (use o menu para navegar).
+void exibirTodosTeritorios(const Mapa* mapa) {
+    OpcoesExibicao opcoes = {EXIBICAO_DETALHADA, 0, TERRITORIOS_POR_PAGINA, -1, 0};
+    if (mapa->quantidade > TERRITORIOS_POR_PAGINA) {
+        opcoes.modo = EXIBICAO_TABELA;
+        opcoes.pagina = 1;
+    }
+    renderizarMapa(mapa, &opcoes, &bufferTerminal);
+}
+
+// Função para exibir o mapa com filtros e paginação escolhidos pelo terminal
+void exibirMapaFiltrado(const Mapa* mapa) {
+    OpcoesExibicao opcoes = {EXIBICAO_TABELA, 1, TERRITORIOS_POR_PAGINA, -1, 0};
+    char cor[10];
+    int modo;
+    
+    printf("Modo (1 - detalhado, 2 - tabela): ");
+    scanf("%d", &modo);
+    opcoes.modo = modo == 1 ? EXIBICAO_DETALHADA : EXIBICAO_TABELA;
+    
+    printf("Cor do exército (ou * para todas): ");
+    scanf(" %9s", cor);
+    if (strcmp(cor, "*") != 0) {
+        opcoes.filtroCor = buscarCor(&mapa->cores, cor);
+        if (opcoes.filtroCor < 0) {
+            printf("Nenhum território da cor '%s'.\n", cor);
+            return;
+        }
+    }
+    
+    printf("Tropas mínimas: ");
+    scanf("%d", &opcoes.tropasMinimas);
+    printf("Página (territórios por página: %d): ", opcoes.tamanhoPagina);
+    scanf("%d", &opcoes.pagina);
+    if (opcoes.pagina < 1) opcoes.pagina = 1;
+    
+    renderizarMapa(mapa, &opcoes, &bufferTerminal);
+}
+
+// Função para simular rolagem de dados (1 a 6)
+int rolarDado(GeradorAleatorio* gerador) {
+    CONTAR_METRICA(CONTADOR_DADOS_SORTEADOS, 1);
+    return sortearIntervalo(gerador, 6) + 1;
+}
+
+// Função que aplica as regras de uma rodada de batalha aos contadores de tropas.
+// É o núcleo compartilhado por atacar() e pela simulação em massa: não faz I/O.
+ResultadoBatalha resolverBatalha(int* tropasAtacante, int* tropasDefensor, 
+                                 int dadoAtacante, int dadoDefensor) {
+    ResultadoBatalha resultado = {0, 0, 0, 0};
+    
+    if (dadoAtacante > dadoDefensor) {
+        // Transferir metade das tropas do atacante (mínimo 1)
+        int tropasTransferidas = (*tropasAtacante / 2) > 0 ? (*tropasAtacante / 2) : 1;
+        resultado.conquistou = 1;
+        resultado.tropasTransferidas = tropasTransferidas;
+        resultado.perdaDefensor = *tropasDefensor;
+        *tropasDefensor = tropasTransferidas;
+        *tropasAtacante -= tropasTransferidas;
+    } else if (*tropasAtacante > 1) {
+        // Atacante perde uma tropa (mínimo 1)
+        (*tropasAtacante)--;
+        resultado.perdaAtacante = 1;
+    }
+    
+    return resultado;
+}
+
+// Função para registrar no log uma rodada já aplicada ao mapa
+static void registrarAtaqueLog(const Mapa* mapa, int atacante, int defensor, const ResultadoBatalha* resultado, 
+                               int dadoAtacante, int dadoDefensor) {
+    EventoLog evento = {.partida = mapa->partidaLog, .tipo = EVENTO_ATAQUE, .origem = atacante, 
+                        .destino = defensor, .deltaOrigem = -resultado->perdaAtacante - resultado->tropasTransferidas,
+                        .deltaDestino = resultado->conquistou ? mapa->tropas[defensor] - resultado->perdaDefensor : 0,
+                        .cor = mapa->cor[atacante], .dados = (uint8_t)(dadoAtacante << 4 | dadoDefensor), 
+                        .conquistou = (uint8_t)resultado->conquistou};
+    registrarEvento(&evento);
+}
+
+// Função que resolve uma rodada entre dois territórios do mapa, sem I/O.
+// Em caso de conquista, o defensor passa para a cor do atacante.
+ResultadoBatalha resolverAtaque(Mapa* mapa, int atacante, int defensor, 
+                                int dadoAtacante, int dadoDefensor) {
+    INICIAR_MEDICAO(LATENCIA_ATAQUE);
+    int tropasAtacante = mapa->tropas[atacante];
+    int tropasDefensor = mapa->tropas[defensor];
+    ResultadoBatalha resultado = resolverBatalha(&tropasAtacante, &tropasDefensor, 
+                                                 dadoAtacante, dadoDefensor);
+    
+    // Aplicar o resultado pelas funções que mantêm os agregados
+    definirTropas(mapa, atacante, tropasAtacante);
+    if (resultado.conquistou) {
+        definirDono(mapa, defensor, mapa->cor[atacante]);
+    }
+    definirTropas(mapa, defensor, tropasDefensor);
+    marcarJogada(mapa->diario);
+    if (mapa->partidaLog != 0) {
+        registrarAtaqueLog(mapa, atacante, defensor, &resultado, dadoAtacante, dadoDefensor);
+    }
+    CONTAR_METRICA(CONTADOR_BATALHAS, 1);
+    CONTAR_METRICA(CONTADOR_CONQUISTAS, resultado.conquistou);
+    ENCERRAR_MEDICAO(LATENCIA_ATAQUE);
+    return resultado;
+}
+
+// Dados sorteados de uma vez pelo ataque relâmpago (cada rodada usa até 5)
+#define BLOCO_DADOS_BLITZ 1024
+#define MAX_DADOS_RODADA 5
+
+// Função auxiliar para ordenar até 3 dados em ordem decrescente
+static inline void ordenarDados(int* dados, int quantidade) {
+    for (int i = 1; i < quantidade; i++) {
+        for (int j = i; j > 0 && dados[j] > dados[j - 1]; j--) {
+            int troca = dados[j];
+            dados[j] = dados[j - 1];
+            dados[j - 1] = troca;
+        }
+    }
+}
+
+// Função que aplica uma rodada da regra clássica: o atacante rola até 3 dados
+// (tropas - 1), o defensor até 2, os maiores são comparados em pares e cada par
+// tira uma tropa de quem perdeu (empate favorece o defensor).
+// Retorna quantos dados foram usados.
+static int resolverRodadaClassica(int* tropasAtacante, int* tropasDefensor, const uint8_t* sorteados) {
+    int dadosAtacante = *tropasAtacante - 1 < 3 ? *tropasAtacante - 1 : 3;
+    int dadosDefensor = *tropasDefensor < 2 ? *tropasDefensor : 2;
+    int ataque[3], defesa[2];
+    
+    for (int i = 0; i < dadosAtacante; i++) ataque[i] = sorteados[i];
+    for (int i = 0; i < dadosDefensor; i++) defesa[i] = sorteados[dadosAtacante + i];
+    ordenarDados(ataque, dadosAtacante);
+    ordenarDados(defesa, dadosDefensor);
+    
+    int pares = dadosAtacante < dadosDefensor ? dadosAtacante : dadosDefensor;
+    for (int i = 0; i < pares; i++) {
+        if (ataque[i] > defesa[i]) (*tropasDefensor)--;
+        else (*tropasAtacante)--;
+    }
+    return dadosAtacante + dadosDefensor;
+}
+
+// Função que resolve um ataque relâmpago sem I/O: repete rodadas entre o par
+// até o defensor cair, o atacante ficar com 1 tropa ou 'maxRodadas' acabar
+// (0: sem limite). Os dados são sorteados em blocos com preencherDados e as
+// rodadas correm sobre contadores locais; o mapa (agregados e diário) só é
+// atualizado no final, como uma única jogada. O ataque já deve ter sido validado.
+ResultadoBlitz resolverBlitz(Mapa* mapa, int atacante, int defensor, GeradorAleatorio* gerador, 
+                             RegraDados regra, int maxRodadas) {
+    ResultadoBlitz resultado = {0, 0, 0, 0, 0};
+    uint8_t dados[BLOCO_DADOS_BLITZ];
+    int usados = BLOCO_DADOS_BLITZ;
+    int tropasAtacante = mapa->tropas[atacante];
+    int tropasDefensor = mapa->tropas[defensor];
+    
+    while (tropasAtacante > 1 && (maxRodadas <= 0 || resultado.rodadas < maxRodadas)) {
+        if (usados > BLOCO_DADOS_BLITZ - MAX_DADOS_RODADA) {
+            preencherDados(gerador, dados, BLOCO_DADOS_BLITZ);
+            usados = 0;
+        }
+        resultado.rodadas++;
+        
+        if (regra == DADOS_CLASSICOS) {
+            usados += resolverRodadaClassica(&tropasAtacante, &tropasDefensor, dados + usados);
+            if (tropasDefensor == 0) {
+                // Ocupação pela mesma regra do jogo: metade das tropas (mínimo 1)
+                resultado.conquistou = 1;
+                resultado.tropasTransferidas = tropasAtacante / 2 > 0 ? tropasAtacante / 2 : 1;
+                tropasDefensor = resultado.tropasTransferidas;
+                tropasAtacante -= resultado.tropasTransferidas;
+                break;
+            }
+        } else {
+            ResultadoBatalha rodada = resolverBatalha(&tropasAtacante, &tropasDefensor, 
+                                                      dados[usados], dados[usados + 1]);
+            usados += 2;
+            if (rodada.conquistou) {
+                resultado.conquistou = 1;
+                resultado.tropasTransferidas = rodada.tropasTransferidas;
+                resultado.perdasDefensor = rodada.perdaDefensor;
+                break;
+            }
+        }
+    }
+    
+    int tropasAntes = mapa->tropas[atacante];
+    resultado.perdasAtacante = tropasAntes - tropasAtacante - resultado.tropasTransferidas;
+    if (regra == DADOS_CLASSICOS) {
+        resultado.perdasDefensor = mapa->tropas[defensor] - 
+                                   (resultado.conquistou ? 0 : tropasDefensor);
+    }
+    if (mapa->partidaLog != 0) {
+        EventoLog evento = {.partida = mapa->partidaLog, .tipo = EVENTO_BLITZ, .origem = atacante, 
+                            .destino = defensor, .deltaOrigem = tropasAtacante - tropasAntes, 
+                            .deltaDestino = tropasDefensor - mapa->tropas[defensor], 
+                            .extra = (uint32_t)resultado.rodadas, .cor = mapa->cor[atacante], 
+                            .dados = (uint8_t)regra, .conquistou = (uint8_t)resultado.conquistou};
+        registrarEvento(&evento);
+    }
+    
+    definirTropas(mapa, atacante, tropasAtacante);
+    if (resultado.conquistou) {
+        definirDono(mapa, defensor, mapa->cor[atacante]);
+    }
+    definirTropas(mapa, defensor, tropasDefensor);
+    marcarJogada(mapa->diario);
+    CONTAR_METRICA(CONTADOR_BATALHAS, resultado.rodadas);
+    CONTAR_METRICA(CONTADOR_CONQUISTAS, resultado.conquistou);
+    return resultado;
+}
+
+// Função para calcular as chances exatas de uma única rolagem
+ChancesAtaque calcularChancesRodada(int tropasAtacante, int tropasDefensor) {
+    ChancesAtaque chances = {0, 0, 0, 0, 0};
+    if (tropasAtacante < 2 || tropasDefensor < 1) {
+        // Ataque inválido: nada muda
+        chances.tropasAtacante = tropasAtacante;
+        chances.tropasDefensor = tropasDefensor;
+        return chances;
+    }
+    
+    double vitoria = (double)VITORIAS_ROLAGEM / COMBINACOES_ROLAGEM;
+    int ocupacao = tropasAtacante / 2;
+    chances.conquista = vitoria;
+    chances.tropasAtacante = vitoria * (tropasAtacante - ocupacao) + (1 - vitoria) * (tropasAtacante - 1);
+    chances.tropasOcupacao = vitoria * ocupacao;
+    chances.tropasDefensor = (1 - vitoria) * tropasDefensor;
+    chances.rodadas = 1;
+    return chances;
+}
+
+// Memória dos ataques repetidos. Pelas regras atuais o defensor nunca perde
+// tropas sem perder o território, então o estado da cadeia de Markov é só o
+// número de tropas do atacante; o defensor entra apenas como fator no final.
+static ChancesAtaque memoChances[MAX_TROPAS_MEMO + 1];
+static pthread_once_t memoChancesPronta = PTHREAD_ONCE_INIT;
+
+// Função que avança a recorrência um passo: X(a) = p * conquista(a) + q * X(a - 1)
+static ChancesAtaque passoChances(const ChancesAtaque* anterior, int tropasAtacante) {
+    double vitoria = (double)VITORIAS_ROLAGEM / COMBINACOES_ROLAGEM;
+    int ocupacao = tropasAtacante / 2;
+    ChancesAtaque chances;
+    chances.conquista = vitoria + (1 - vitoria) * anterior->conquista;
+    chances.tropasAtacante = vitoria * (tropasAtacante - ocupacao) + (1 - vitoria) * anterior->tropasAtacante;
+    chances.tropasOcupacao = vitoria * ocupacao + (1 - vitoria) * anterior->tropasOcupacao;
+    chances.tropasDefensor = 0;
+    chances.rodadas = 1 + (1 - vitoria) * anterior->rodadas;
+    return chances;
+}
+
+// Função para preencher a tabela memorizada (executada uma vez, seguro entre threads)
+static void preencherMemoChances() {
+    // Com 1 tropa o atacante não pode mais atacar: exaustão
+    memset(memoChances, 0, sizeof(memoChances));
+    memoChances[0].tropasAtacante = 0;
+    memoChances[1].tropasAtacante = 1;
+    for (int a = 2; a <= MAX_TROPAS_MEMO; a++) {
+        memoChances[a] = passoChances(&memoChances[a - 1], a);
+    }
+}
+
+// Função para calcular as chances de atacar repetidamente até conquistar o
+// território ou ficar com 1 tropa. Custa O(1) até MAX_TROPAS_MEMO tropas.
+ChancesAtaque calcularChancesAteConquista(int tropasAtacante, int tropasDefensor) {
+    ChancesAtaque chances;
+    
+    if (tropasAtacante < 2 || tropasDefensor < 1) {
+        return calcularChancesRodada(tropasAtacante, tropasDefensor);
+    }
+    pthread_once(&memoChancesPronta, preencherMemoChances);
+    
+    if (tropasAtacante <= MAX_TROPAS_MEMO) {
+        chances = memoChances[tropasAtacante];
+    } else {
+        // Acima da tabela, continua a recorrência a partir da última entrada
+        chances = memoChances[MAX_TROPAS_MEMO];
+        for (int a = MAX_TROPAS_MEMO + 1; a <= tropasAtacante; a++) {
+            chances = passoChances(&chances, a);
+        }
+    }
+    chances.tropasDefensor = (1 - chances.conquista) * tropasDefensor;
+    return chances;
+}
+
+// Função para obter a distribuição completa dos ataques repetidos.
+// conquista[m] (m = 2..tropasAtacante) recebe a probabilidade de a conquista
+// acontecer com o atacante tendo m tropas na rolagem vencedora (ficam m - m/2
+// na origem e m/2 ocupam o território); conquista deve ter tropasAtacante + 1 posições.
+// Retorna a probabilidade de exaustão (atacante termina com 1 tropa).
+double distribuirChancesAtaque(int tropasAtacante, double* conquista) {
+    double vitoria = (double)VITORIAS_ROLAGEM / COMBINACOES_ROLAGEM;
+    double caminho = 1; // Probabilidade de chegar à rolagem com m tropas
+    
+    for (int m = 0; m <= tropasAtacante; m++) conquista[m] = 0;
+    if (tropasAtacante < 2) return 1;
+    
+    for (int m = tropasAtacante; m >= 2; m--) {
+        conquista[m] = caminho * vitoria;
+        caminho *= 1 - vitoria;
+    }
+    return caminho;
+}
+
+// Tabela da regra clássica: perdasClassicas[a][d][k] é a probabilidade de o
+// atacante perder k tropas (e o defensor o restante dos pares) em uma rolagem
+// de a dados contra d. Calculada uma vez enumerando as 6^(a+d) combinações.
+static double perdasClassicas[4][3][3];
+static pthread_once_t perdasClassicasPronta = PTHREAD_ONCE_INIT;
+
+// Função para preencher a tabela da regra clássica (executada uma vez, seguro entre threads)
+static void preencherPerdasClassicas() {
+    uint8_t sorteados[MAX_DADOS_RODADA];
+    for (int a = 1; a <= 3; a++) {
+        for (int d = 1; d <= 2; d++) {
+            int combinacoes = 1;
+            for (int i = 0; i < a + d; i++) combinacoes *= FACES_DADO;
+            for (int c = 0; c < combinacoes; c++) {
+                // Cada combinação é um número de a + d dígitos na base 6
+                int resto = c;
+                for (int i = 0; i < a + d; i++) {
+                    sorteados[i] = (uint8_t)(resto % FACES_DADO + 1);
+                    resto /= FACES_DADO;
+                }
+                int tropasAtacante = a + 1, tropasDefensor = d;
+                resolverRodadaClassica(&tropasAtacante, &tropasDefensor, sorteados);
+                perdasClassicas[a][d][a + 1 - tropasAtacante] += 1.0 / combinacoes;
+            }
+        }
+    }
+}
+
+// Função para calcular as chances exatas de uma única rolagem da regra clássica
+ChancesAtaque calcularChancesRodadaClassica(int tropasAtacante, int tropasDefensor) {
+    if (tropasAtacante < 2 || tropasDefensor < 1) {
+        return calcularChancesRodada(tropasAtacante, tropasDefensor);
+    }
+    pthread_once(&perdasClassicasPronta, preencherPerdasClassicas);
+    
+    int dadosAtacante = tropasAtacante - 1 < 3 ? tropasAtacante - 1 : 3;
+    int dadosDefensor = tropasDefensor < 2 ? tropasDefensor : 2;
+    int pares = dadosAtacante < dadosDefensor ? dadosAtacante : dadosDefensor;
+    ChancesAtaque chances = {0, 0, 0, 0, 1};
+    for (int k = 0; k <= pares; k++) {
+        double p = perdasClassicas[dadosAtacante][dadosDefensor][k];
+        int a = tropasAtacante - k, d = tropasDefensor - (pares - k);
+        if (d == 0) {
+            chances.conquista += p;
+            chances.tropasAtacante += p * (a - a / 2);
+            chances.tropasOcupacao += p * (a / 2);
+        } else {
+            chances.tropasAtacante += p * a;
+            chances.tropasDefensor += p * d;
+        }
+    }
+    return chances;
+}
+
+// Função para calcular as chances exatas de atacar repetidamente pela regra
+// clássica, por programação dinâmica sobre os estados (tropas do atacante,
+// tropas do defensor) em O(A x D). Cada rolagem tira 1 ou 2 tropas do
+// atacante no máximo, então bastam três linhas de estados em memória.
+// Se conquista não é NULL, conquista[m] (m = 2..tropasAtacante) recebe a
+// probabilidade de conquistar com m tropas no atacante (tropasAtacante + 1 posições).
+ChancesAtaque calcularChancesClassicas(int tropasAtacante, int tropasDefensor, double* conquista) {
+    ChancesAtaque chances = {0, 0, 0, 0, 0};
+    if (conquista != NULL) {
+        for (int m = 0; m <= tropasAtacante; m++) conquista[m] = 0;
+    }
+    if (tropasAtacante < 2 || tropasDefensor < 1) {
+        return calcularChancesRodada(tropasAtacante, tropasDefensor);
+    }
+    pthread_once(&perdasClassicasPronta, preencherPerdasClassicas);
+    
+    // linhas[a % 3][d]: probabilidade de chegar ao estado (a, d) ainda em combate
+    double* linhas[3];
+    for (int i = 0; i < 3; i++) {
+        linhas[i] = (double*)calloc((size_t)tropasDefensor + 1, sizeof(double));
+        if (linhas[i] == NULL) {
+            printf("Erro: Falha na alocação de memória para as chances!\n");
+            exit(1);
+        }
+    }
+    linhas[tropasAtacante % 3][tropasDefensor] = 1;
+    
+    for (int a = tropasAtacante; a >= 2; a--) {
+        double* linha = linhas[a % 3];
+        // A linha a - 2 recebe massa a partir daqui; ela guardava a linha a + 1, já processada
+        memset(linhas[(a + 1) % 3], 0, ((size_t)tropasDefensor + 1) * sizeof(double));
+        
+        for (int d = tropasDefensor; d >= 1; d--) {
+            double massa = linha[d];
+            if (massa == 0) continue;
+            chances.rodadas += massa;
+            
+            int dadosAtacante = a - 1 < 3 ? a - 1 : 3;
+            int dadosDefensor = d < 2 ? d : 2;
+            int pares = dadosAtacante < dadosDefensor ? dadosAtacante : dadosDefensor;
+            for (int k = 0; k <= pares; k++) {
+                double p = massa * perdasClassicas[dadosAtacante][dadosDefensor][k];
+                int proximoA = a - k, proximoD = d - (pares - k);
+                if (proximoD == 0) {
+                    chances.conquista += p;
+                    chances.tropasAtacante += p * (proximoA - proximoA / 2);
+                    chances.tropasOcupacao += p * (proximoA / 2);
+                    if (conquista != NULL) conquista[proximoA] += p;
+                } else if (proximoA == 1) {
+                    chances.tropasAtacante += p;
+                    chances.tropasDefensor += p * proximoD;
+                } else {
+                    linhas[proximoA % 3][proximoD] += p;
+                }
+            }
+        }
+    }
+    
+    for (int i = 0; i < 3; i++) free(linhas[i]);
+    return chances;
+}
+
+// Função para mostrar as chances antes de um ataque do menu
+void exibirChancesAtaque(int tropasAtacante, int tropasDefensor) {
+    ChancesAtaque rodada = calcularChancesRodada(tropasAtacante, tropasDefensor);
+    ChancesAtaque repetido = calcularChancesAteConquista(tropasAtacante, tropasDefensor);
+    
+    printf("\nChances: %.2f%% de conquista nesta rolagem; %.2f%% atacando até conquistar ou ficar com 1 tropa "
+           "(%.1f rolagens em média)\n", 100 * rodada.conquista, 100 * repetido.conquista, repetido.rodadas);
+}
+
+// Função principal de ataque entre territórios
+void atacar(Mapa* mapa, int atacante, int defensor, GeradorAleatorio* gerador) {
+    const char* nomeAtacante = nomeTerritorio(mapa, atacante);
+    const char* nomeDefensor = nomeTerritorio(mapa, defensor);
+    const char* corAtacante = nomeCor(&mapa->cores, mapa->cor[atacante]);
+    
+    printf("\n=== SIMULAÇÃO DE BATALHA ===\n");
+    printf("Atacante: %s (%s) com %d tropas\n", 
+           nomeAtacante, corAtacante, mapa->tropas[atacante]);
+    printf("Defensor: %s (%s) com %d tropas\n", 
+           nomeDefensor, nomeCor(&mapa->cores, mapa->cor[defensor]), mapa->tropas[defensor]);
+    
+    // Simular rolagem de dados
+    int dadoAtacante = rolarDado(gerador);
+    int dadoDefensor = rolarDado(gerador);
+    
+    printf("\nRolagem de dados:\n");
+    printf("Atacante (%s): %d\n", corAtacante, dadoAtacante);
+    printf("Defensor (%s): %d\n", nomeCor(&mapa->cores, mapa->cor[defensor]), dadoDefensor);
+    
+    // Determinar resultado da batalha
+    ResultadoBatalha resultado = resolverAtaque(mapa, atacante, defensor, dadoAtacante, dadoDefensor);
+    if (resultado.conquistou) {
+        printf("\n🎯 VITÓRIA DO ATACANTE!\n");
+        printf("O território '%s' foi conquistado por %s!\n", nomeDefensor, corAtacante);
+        printf("Tropas transferidas: %d\n", resultado.tropasTransferidas);
+    } else {
+        printf("\n🛡️ DEFESA BEM-SUCEDIDA!\n");
+        printf("O território '%s' resistiu ao ataque!\n", nomeDefensor);
+        
+        if (resultado.perdaAtacante) {
+            printf("O atacante perdeu 1 tropa na batalha.\n");
+        } else {
+            printf("O atacante não pode perder mais tropas (mínimo 1).\n");
+        }
+    }
+    
+    printf("\nResultado pós-batalha:\n");
+    printf("- %s (%s): %d tropas\n", 
+           nomeAtacante, nomeCor(&mapa->cores, mapa->cor[atacante]), mapa->tropas[atacante]);
+    printf("- %s (%s): %d tropas\n", 
+           nomeDefensor, nomeCor(&mapa->cores, mapa->cor[defensor]), mapa->tropas[defensor]);
+}
+
+// Função para aplicar as regras de ataque, na ordem em que são verificadas
+static inline MotivoAtaque classificarAtaque(const Mapa* mapa, int atacante, int defensor) {
+    // Verificar se são territórios diferentes
+    if (atacante == defensor) return ATAQUE_MESMO_TERRITORIO;
+    
+    // Verificar se o atacante tem tropas suficientes
+    if (mapa->tropas[atacante] < 2) return ATAQUE_TROPAS_INSUFICIENTES;
+    
+    // Verificar se não é um ataque da mesma cor (aliados)
+    if (mapa->cor[atacante] == mapa->cor[defensor]) return ATAQUE_MESMA_COR;
+    
+    // Verificar se os territórios fazem fronteira
+    if (!fazemFronteira(mapa, atacante, defensor)) return ATAQUE_SEM_FRONTEIRA;
+    
+    return ATAQUE_VALIDO;
+}
+
+// Função para classificar um ataque sem imprimir nada
+MotivoAtaque analisarAtaque(const Mapa* mapa, int atacante, int defensor) {
+    MotivoAtaque motivo = classificarAtaque(mapa, atacante, defensor);
+    if (motivo != ATAQUE_VALIDO) CONTAR_METRICA(CONTADOR_ATAQUES_REJEITADOS, 1);
+    return motivo;
+}
+
+// Função para validar se um ataque é válido
+int validarAtaque(const Mapa* mapa, int atacante, int defensor) {
+    switch (analisarAtaque(mapa, atacante, defensor)) {
+        case ATAQUE_MESMO_TERRITORIO:
+            printf("Erro: Um território não pode atacar a si mesmo!\n");
+            return 0;
+        case ATAQUE_TROPAS_INSUFICIENTES:
+            printf("Erro: O território atacante deve ter pelo menos 2 tropas para atacar!\n");
+            return 0;
+        case ATAQUE_MESMA_COR:
+            printf("Erro: Territórios da mesma cor não podem se atacar!\n");
+            return 0;
+        case ATAQUE_SEM_FRONTEIRA:
+            printf("Erro: Os territórios não fazem fronteira!\n");
+            return 0;
+        default:
+            return 1; // Ataque válido
+    }
+}
+
+// Função para ler do terminal o par atacante/defensor (pela posição ou pelo nome)
+static void escolherParAtaque(const Mapa* mapa, int* indiceAtacante, int* indiceDefensor) {
+    int quantidade = mapa->quantidade;
+    char escolha[30];
+    
+    // Selecionar território atacante
+    do {
+        printf("\nEscolha o território ATACANTE (1 a %d ou nome): ", quantidade);
+        scanf(" %29s", escolha);
+        *indiceAtacante = interpretarTerritorio(mapa, escolha);
+        
+        if (*indiceAtacante < 0) {
+            printf("Erro: Território inválido! Escolha entre 1 e %d ou digite um nome.\n", quantidade);
+        } else if (mapa->tropas[*indiceAtacante] < 2) {
+            printf("Erro: O território '%s' não tem tropas suficientes para atacar!\n", 
+                   nomeTerritorio(mapa, *indiceAtacante));
+            *indiceAtacante = -1; // Forçar nova seleção
+        }
+    } while (*indiceAtacante < 0);
+    
+    // Selecionar território defensor
+    do {
+        printf("Escolha o território DEFENSOR (1 a %d ou nome): ", quantidade);
+        scanf(" %29s", escolha);
+        *indiceDefensor = interpretarTerritorio(mapa, escolha);
+        
+        if (*indiceDefensor < 0) {
+            printf("Erro: Território inválido! Escolha entre 1 e %d ou digite um nome.\n", quantidade);
+        }
+    } while (*indiceDefensor < 0);
+}
+
+// Função para selecionar territórios para batalha
+void selecionarEAtacar(Mapa* mapa, GeradorAleatorio* gerador) {
+    int indiceAtacante, indiceDefensor;
+    
+    printf("\n=== SELEÇÃO DE TERRITÓRIOS PARA BATALHA ===\n");
+    
+    // Exibir territórios disponíveis
+    exibirTodosTeritorios(mapa);
+    escolherParAtaque(mapa, &indiceAtacante, &indiceDefensor);
+    
+    // Validar e executar o ataque
+    if (validarAtaque(mapa, indiceAtacante, indiceDefensor)) {
+        exibirChancesAtaque(mapa->tropas[indiceAtacante], mapa->tropas[indiceDefensor]);
+        atacar(mapa, indiceAtacante, indiceDefensor, gerador);
+    }
+}
+
+// Função para o ataque relâmpago do menu: escolhe o par, a regra e o limite
+// de rodadas, resolve tudo sem saída intermediária e mostra um único resumo
+void selecionarEAtacarBlitz(Mapa* mapa, GeradorAleatorio* gerador) {
+    int indiceAtacante, indiceDefensor, regra, maxRodadas;
+    
+    printf("\n=== ATAQUE RELÂMPAGO (BLITZ) ===\n");
+    escolherParAtaque(mapa, &indiceAtacante, &indiceDefensor);
+    
+    printf("Regra dos dados (1 - um contra um, 2 - clássica 3x2): ");
+    scanf("%d", &regra);
+    printf("Limite de rodadas (0 - até conquistar ou ficar com 1 tropa): ");
+    scanf("%d", &maxRodadas);
+    
+    if (!validarAtaque(mapa, indiceAtacante, indiceDefensor)) return;
+    
+    RegraDados regraDados = regra == 2 ? DADOS_CLASSICOS : DADOS_UM_A_UM;
+    int tropasAtacante = mapa->tropas[indiceAtacante];
+    int tropasDefensor = mapa->tropas[indiceDefensor];
+    ChancesAtaque chances = regraDados == DADOS_CLASSICOS 
+                            ? calcularChancesClassicas(tropasAtacante, tropasDefensor, NULL)
+                            : calcularChancesAteConquista(tropasAtacante, tropasDefensor);
+    printf("\nChances sem limite de rodadas: %.2f%% de conquista (%.1f rolagens em média)\n", 
+           100 * chances.conquista, chances.rodadas);
+    
+    ResultadoBlitz resultado = resolverBlitz(mapa, indiceAtacante, indiceDefensor, gerador, 
+                                             regraDados, maxRodadas);
+    const char* nomeDefensor = nomeTerritorio(mapa, indiceDefensor);
+    
+    printf("\n=== RESUMO DO ATAQUE RELÂMPAGO ===\n");
+    printf("Rodadas: %d | Perdas: atacante %d, defensor %d\n", 
+           resultado.rodadas, resultado.perdasAtacante, resultado.perdasDefensor);
+    if (resultado.conquistou) {
+        printf("🎯 O território '%s' foi conquistado por %s! Tropas transferidas: %d\n", 
+               nomeDefensor, nomeCor(&mapa->cores, mapa->cor[indiceAtacante]), 
+               resultado.tropasTransferidas);
+    } else if (mapa->tropas[indiceAtacante] < 2) {
+        printf("🛡️ O território '%s' resistiu: o atacante ficou com 1 tropa.\n", nomeDefensor);
+    } else {
+        printf("⏸️ Limite de rodadas atingido: '%s' resiste com %d tropas.\n", 
+               nomeDefensor, mapa->tropas[indiceDefensor]);
+    }
+    printf("- %s (%s): %d tropas\n", nomeTerritorio(mapa, indiceAtacante), 
+           nomeCor(&mapa->cores, mapa->cor[indiceAtacante]), mapa->tropas[indiceAtacante]);
+    printf("- %s (%s): %d tropas\n", nomeDefensor, 
+           nomeCor(&mapa->cores, mapa->cor[indiceDefensor]), mapa->tropas[indiceDefensor]);
+}
+
+// Turnos simultâneos: todos os jogadores enviam suas ordens de ataque e o
+// turno inteiro é resolvido de uma vez. O mapa é dividido em fatias de
+// territórios consecutivos; ordens com os dois territórios na mesma fatia não
+// disputam nada com as de outras fatias e são resolvidas em paralelo, uma
+// fatia por thread. O tamanho da fatia é fixo (não depende do número de
+// threads), então a ordem de resolução e o resultado também são.
+#define TERRITORIOS_POR_FATIA 16384
+
+// Situação de uma ordem depois do turno
+typedef enum {
+    ORDEM_CANCELADA,        // Inválida quando chegou a sua vez (ex.: o atacante já tinha caído)
+    ORDEM_REPELIDA,
+    ORDEM_CONQUISTOU
+} SituacaoOrdem;
+
+// Ordem de ataque enviada por um jogador para o turno simultâneo
+typedef struct {
+    int32_t atacante;
+    int32_t defensor;
+    uint8_t cor;            // Cor de quem deu a ordem: ela cai se o atacante mudou de dono
+    uint8_t situacao;       // SituacaoOrdem, preenchida na resolução
+} OrdemAtaque;
+
+// Totais de um turno simultâneo
+typedef struct {
+    long long executadas;
+    long long conquistas;
+    long long canceladas;
+    long long entreFatias;  // Ordens entre duas fatias, resolvidas em série
+} ResumoTurno;
+
+// Parcial de uma thread: variações dos agregados e contagem das ordens,
+// somadas ao mapa quando todas as fatias terminam
+typedef struct {
+    long long tropas[MAX_CORES];
+    int territorios[MAX_CORES];
+    int acimaLimite[MAX_CORES];
+    int centros[MAX_CORES];
+    int posseOrigem[MAX_CORES][MAX_CORES];
+    ResumoTurno resumo;
+} ParcialTurno;
+
+// Tarefa executada sobre uma fatia por executarPorFatias
+typedef void (*TarefaFatia)(void* contexto, int fatia, int trabalhador);
+
+struct GrupoFatias;
+
+// Argumento de cada thread do grupo
+typedef struct {
+    struct GrupoFatias* grupo;
+    int indice;
+} TrabalhadorFatias;
+
+// Grupo de threads que vive enquanto o resolvedor existir: a cada tarefa as
+// threads acordam, dividem as fatias entre si e voltam a dormir. Assim um
+// turno não cria threads (nem buffers de log e métricas novos por thread).
+typedef struct GrupoFatias {
+    pthread_mutex_t trava;
+    pthread_cond_t novaTarefa;      // Sinalizada quando 'geracao' avança ou no encerramento
+    pthread_cond_t tarefaConcluida; // Sinalizada quando 'pendentes' chega a 0
+    uint64_t geracao;               // Tarefas entregues até agora
+    int pendentes;                  // Threads do grupo que ainda não terminaram a tarefa atual
+    int encerrar;
+    int numThreads;                 // Incluindo a que entrega as tarefas (índice 0)
+    TarefaFatia tarefa;
+    void* contexto;
+    int numFatias;
+    _Atomic int proxima;            // Próxima fatia ainda não distribuída
+    pthread_t threads[MAX_THREADS_SIMULACAO];
+    TrabalhadorFatias trabalhadores[MAX_THREADS_SIMULACAO];
+} GrupoFatias;
+
+// Estado reaproveitado entre os turnos de uma partida
+typedef struct {
+    Mapa* mapa;
+    int numThreads;
+    int numFatias;
+    uint8_t* corInicial;        // Cor de cada território no início do turno
+    _Atomic int* fatiaAlterada; // Fatias com território (ou vizinho) que trocou de dono
+    long long* inicioBalde;     // numFatias + 2 posições; o último balde guarda as ordens entre fatias
+    long long* posicaoBalde;
+    long long* ordensBalde;     // Índices das ordens, agrupados por balde
+    long long capacidadeBalde;
+    ParcialTurno* parciais;     // Uma por thread
+    GrupoFatias* grupo;
+    // Turno em andamento
+    OrdemAtaque* ordens;
+    uint64_t semente;
+} ResolvedorTurno;
+
+// Função auxiliar: pega a próxima fatia livre da tarefa atual até acabarem
+static void processarFatias(GrupoFatias* grupo, int trabalhador) {
+    int fatia;
+    while ((fatia = atomic_fetch_add_explicit(&grupo->proxima, 1, memory_order_relaxed)) < grupo->numFatias) {
+        grupo->tarefa(grupo->contexto, fatia, trabalhador);
+    }
+}
+
+// Função executada por cada thread do grupo: espera uma tarefa nova, trabalha
+// nela e avisa quando terminou, até o grupo ser encerrado
+static void* executarTrabalhadorFatias(void* argumento) {
+    TrabalhadorFatias* trabalhador = (TrabalhadorFatias*)argumento;
+    GrupoFatias* grupo = trabalhador->grupo;
+    uint64_t vista = 0;
+    
+    pthread_mutex_lock(&grupo->trava);
+    for (;;) {
+        while (grupo->geracao == vista && !grupo->encerrar) {
+            pthread_cond_wait(&grupo->novaTarefa, &grupo->trava);
+        }
+        if (grupo->encerrar) break;
+        vista = grupo->geracao;
+        pthread_mutex_unlock(&grupo->trava);
+        
+        processarFatias(grupo, trabalhador->indice);
+        
+        pthread_mutex_lock(&grupo->trava);
+        if (--grupo->pendentes == 0) pthread_cond_signal(&grupo->tarefaConcluida);
+    }
+    pthread_mutex_unlock(&grupo->trava);
+    return NULL;
+}
+
+// Função para criar o grupo com até numThreads threads (contando a que chama).
+// Se faltarem threads, o grupo fica menor. Retorna NULL se faltou memória.
+GrupoFatias* criarGrupoFatias(int numThreads) {
+    GrupoFatias* grupo = (GrupoFatias*)calloc(1, sizeof(GrupoFatias));
+    if (grupo == NULL) return NULL;
+    pthread_mutex_init(&grupo->trava, NULL);
+    pthread_cond_init(&grupo->novaTarefa, NULL);
+    pthread_cond_init(&grupo->tarefaConcluida, NULL);
+    atomic_init(&grupo->proxima, 0);
+    
+    grupo->numThreads = 1;
+    for (int t = 0; t < numThreads; t++) {
+        grupo->trabalhadores[t].grupo = grupo;
+        grupo->trabalhadores[t].indice = t;
+    }
+    while (grupo->numThreads < numThreads && 
+           pthread_create(&grupo->threads[grupo->numThreads], NULL, executarTrabalhadorFatias, 
+                          &grupo->trabalhadores[grupo->numThreads]) == 0) {
+        grupo->numThreads++;
+    }
+    return grupo;
+}
+
+// Função para encerrar as threads do grupo e liberá-lo
+void liberarGrupoFatias(GrupoFatias* grupo) {
+    if (grupo == NULL) return;
+    pthread_mutex_lock(&grupo->trava);
+    grupo->encerrar = 1;
+    pthread_cond_broadcast(&grupo->novaTarefa);
+    pthread_mutex_unlock(&grupo->trava);
+    for (int t = 1; t < grupo->numThreads; t++) {
+        pthread_join(grupo->threads[t], NULL);
+    }
+    pthread_cond_destroy(&grupo->tarefaConcluida);
+    pthread_cond_destroy(&grupo->novaTarefa);
+    pthread_mutex_destroy(&grupo->trava);
+    free(grupo);
+}
+
+// Função para executar uma tarefa sobre todas as fatias com as threads do
+// grupo (a que chama também trabalha, como trabalhador 0). Retorna quando
+// todas as fatias terminaram.
+void executarPorFatias(GrupoFatias* grupo, int numFatias, TarefaFatia tarefa, void* contexto) {
+    pthread_mutex_lock(&grupo->trava);
+    grupo->tarefa = tarefa;
+    grupo->contexto = contexto;
+    grupo->numFatias = numFatias;
+    atomic_store_explicit(&grupo->proxima, 0, memory_order_relaxed);
+    grupo->pendentes = grupo->numThreads - 1;
+    grupo->geracao++;
+    pthread_cond_broadcast(&grupo->novaTarefa);
+    pthread_mutex_unlock(&grupo->trava);
+    
+    processarFatias(grupo, 0);
+    
+    pthread_mutex_lock(&grupo->trava);
+    while (grupo->pendentes > 0) {
+        pthread_cond_wait(&grupo->tarefaConcluida, &grupo->trava);
+    }
+    pthread_mutex_unlock(&grupo->trava);
+}
+
+// Função para preparar o resolvedor de turnos de um mapa já cadastrado e o
+// seu grupo de threads. Retorna 1 em caso de sucesso e 0 se faltou memória.
+int criarResolvedorTurno(ResolvedorTurno* resolvedor, Mapa* mapa, int numThreads) {
+    memset(resolvedor, 0, sizeof(ResolvedorTurno));
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS_SIMULACAO) numThreads = MAX_THREADS_SIMULACAO;
+    resolvedor->mapa = mapa;
+    resolvedor->numFatias = (mapa->quantidade + TERRITORIOS_POR_FATIA - 1) / TERRITORIOS_POR_FATIA;
+    if (resolvedor->numFatias == 0) resolvedor->numFatias = 1;
+    // Mais threads que fatias não teriam o que fazer
+    if (numThreads > resolvedor->numFatias) numThreads = resolvedor->numFatias;
+    
+    resolvedor->corInicial = (uint8_t*)malloc(mapa->quantidade > 0 ? mapa->quantidade : 1);
+    resolvedor->fatiaAlterada = (_Atomic int*)calloc(resolvedor->numFatias, sizeof(_Atomic int));
+    resolvedor->inicioBalde = (long long*)malloc((resolvedor->numFatias + 2) * sizeof(long long));
+    resolvedor->posicaoBalde = (long long*)malloc((resolvedor->numFatias + 2) * sizeof(long long));
+    resolvedor->parciais = (ParcialTurno*)calloc(numThreads, sizeof(ParcialTurno));
+    resolvedor->grupo = criarGrupoFatias(numThreads);
+    resolvedor->numThreads = resolvedor->grupo != NULL ? resolvedor->grupo->numThreads : 1;
+    return resolvedor->corInicial != NULL && resolvedor->fatiaAlterada != NULL && 
+           resolvedor->inicioBalde != NULL && resolvedor->posicaoBalde != NULL && 
+           resolvedor->parciais != NULL && resolvedor->grupo != NULL;
+}
+
+// Função para encerrar o grupo de threads e liberar o que o resolvedor alocou
+void liberarResolvedorTurno(ResolvedorTurno* resolvedor) {
+    liberarGrupoFatias(resolvedor->grupo);
+    free(resolvedor->corInicial);
+    free((void*)resolvedor->fatiaAlterada);
+    free(resolvedor->inicioBalde);
+    free(resolvedor->posicaoBalde);
+    free(resolvedor->ordensBalde);
+    free(resolvedor->parciais);
+    memset(resolvedor, 0, sizeof(ResolvedorTurno));
+}
+
+// Função para alterar as tropas de um território durante um turno simultâneo:
+// como definirTropas, mas os agregados variam só na parcial da thread
+void alterarTropasTurno(Mapa* mapa, ParcialTurno* parcial, int indice, int tropas) {
+    uint8_t dono = mapa->cor[indice];
+    int anteriores = mapa->tropas[indice];
+    
+    parcial->tropas[dono] += tropas - anteriores;
+    parcial->acimaLimite[dono] += (tropas > LIMITE_TROPAS_MISSAO) - (anteriores > LIMITE_TROPAS_MISSAO);
+    mapa->tropas[indice] = tropas;
+}
+
+// Função para trocar o dono de um território durante um turno simultâneo.
+// Os vizinhos aliados são recontados depois, quando nenhuma cor muda mais.
+static void trocarDonoTurno(ResolvedorTurno* resolvedor, ParcialTurno* parcial, int indice, uint8_t cor) {
+    Mapa* mapa = resolvedor->mapa;
+    uint8_t anterior = mapa->cor[indice];
+    uint8_t origem = mapa->corOriginal[indice];
+    int tropas = mapa->tropas[indice];
+    int acima = tropas > LIMITE_TROPAS_MISSAO;
+    
+    parcial->territorios[anterior]--;
+    parcial->tropas[anterior] -= tropas;
+    parcial->acimaLimite[anterior] -= acima;
+    parcial->posseOrigem[anterior][origem]--;
+    parcial->territorios[cor]++;
+    parcial->tropas[cor] += tropas;
+    parcial->acimaLimite[cor] += acima;
+    parcial->posseOrigem[cor][origem]++;
+    mapa->cor[indice] = cor;
+    
+    // A fatia do território e as dos seus vizinhos precisam recontar aliados
+    int implicitos[2];
+    const int* vizinhos;
+    int grau = listarVizinhos(mapa, indice, &vizinhos, implicitos);
+    atomic_store_explicit(&resolvedor->fatiaAlterada[indice / TERRITORIOS_POR_FATIA], 1, memory_order_relaxed);
+    for (int i = 0; i < grau; i++) {
+        atomic_store_explicit(&resolvedor->fatiaAlterada[vizinhos[i] / TERRITORIOS_POR_FATIA], 1, 
+                              memory_order_relaxed);
+    }
+}
+
+// Função para resolver uma ordem com os dados do seu próprio fluxo aleatório
+// (semente do turno, posição da ordem), então o resultado não depende de qual
+// thread a executou. Sem parcial, usa os setters e grava no diário.
+static void executarOrdem(ResolvedorTurno* resolvedor, long long indice, ParcialTurno* parcial, 
+                          ResumoTurno* resumo) {
+    Mapa* mapa = resolvedor->mapa;
+    OrdemAtaque* ordem = &resolvedor->ordens[indice];
+    int atacante = ordem->atacante, defensor = ordem->defensor;
+    
+    // A ordem vale para o mapa como está quando chega a sua vez
+    if (mapa->cor[atacante] != ordem->cor || analisarAtaque(mapa, atacante, defensor) != ATAQUE_VALIDO) {
+        ordem->situacao = ORDEM_CANCELADA;
+        resumo->canceladas++;
+        return;
+    }
+    
+    GeradorAleatorio gerador;
+    inicializarGerador(&gerador, resolvedor->semente, (uint64_t)indice);
+    int dadoAtacante = rolarDado(&gerador);
+    int dadoDefensor = rolarDado(&gerador);
+    int tropasAtacante = mapa->tropas[atacante];
+    int tropasDefensor = mapa->tropas[defensor];
+    ResultadoBatalha resultado = resolverBatalha(&tropasAtacante, &tropasDefensor, dadoAtacante, dadoDefensor);
+    
+    if (parcial != NULL) {
+        alterarTropasTurno(mapa, parcial, atacante, tropasAtacante);
+        if (resultado.conquistou) trocarDonoTurno(resolvedor, parcial, defensor, ordem->cor);
+        alterarTropasTurno(mapa, parcial, defensor, tropasDefensor);
+    } else {
+        definirTropas(mapa, atacante, tropasAtacante);
+        if (resultado.conquistou) definirDono(mapa, defensor, ordem->cor);
+        definirTropas(mapa, defensor, tropasDefensor);
+    }
+    if (mapa->partidaLog != 0) {
+        registrarAtaqueLog(mapa, atacante, defensor, &resultado, dadoAtacante, dadoDefensor);
+    }
+    ordem->situacao = resultado.conquistou ? ORDEM_CONQUISTOU : ORDEM_REPELIDA;
+    resumo->executadas++;
+    resumo->conquistas += resultado.conquistou;
+    CONTAR_METRICA(CONTADOR_BATALHAS, 1);
+    CONTAR_METRICA(CONTADOR_CONQUISTAS, resultado.conquistou);
+}
+
+// Tarefa por fatia: guarda as cores iniciais e resolve as ordens internas, em ordem
+static void resolverOrdensFatia(void* contexto, int fatia, int trabalhador) {
+    ResolvedorTurno* resolvedor = (ResolvedorTurno*)contexto;
+    ParcialTurno* parcial = &resolvedor->parciais[trabalhador];
+    int inicio = fatia * TERRITORIOS_POR_FATIA;
+    int fim = inicio + TERRITORIOS_POR_FATIA;
+    if (fim > resolvedor->mapa->quantidade) fim = resolvedor->mapa->quantidade;
+    
+    if (fim > inicio) memcpy(resolvedor->corInicial + inicio, resolvedor->mapa->cor + inicio, fim - inicio);
+    for (long long k = resolvedor->inicioBalde[fatia]; k < resolvedor->inicioBalde[fatia + 1]; k++) {
+        executarOrdem(resolvedor, resolvedor->ordensBalde[k], parcial, &parcial->resumo);
+    }
+}
+
+// Tarefa por fatia: reconta os vizinhos aliados depois que as cores se
+// estabilizaram. Lê as cores das fatias vizinhas, mas só escreve na sua.
+static void recontarAliadosFatia(void* contexto, int fatia, int trabalhador) {
+    ResolvedorTurno* resolvedor = (ResolvedorTurno*)contexto;
+    Mapa* mapa = resolvedor->mapa;
+    int* centros = resolvedor->parciais[trabalhador].centros;
+    int inicio = fatia * TERRITORIOS_POR_FATIA;
+    int fim = inicio + TERRITORIOS_POR_FATIA;
+    if (fim > mapa->quantidade) fim = mapa->quantidade;
+    
+    if (!atomic_load_explicit(&resolvedor->fatiaAlterada[fatia], memory_order_relaxed)) return;
+    atomic_store_explicit(&resolvedor->fatiaAlterada[fatia], 0, memory_order_relaxed);
+    for (int t = inicio; t < fim; t++) {
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        int aliados = 0;
+        for (int i = 0; i < grau; i++) {
+            aliados += mapa->cor[vizinhos[i]] == mapa->cor[t];
+        }
+        if (aliados == mapa->aliados[t] && mapa->cor[t] == resolvedor->corInicial[t]) continue;
+        centros[resolvedor->corInicial[t]] -= mapa->aliados[t] >= 2;
+        centros[mapa->cor[t]] += aliados >= 2;
+        mapa->aliados[t] = aliados;
+    }
+}
+
+// Função para somar as parciais das threads aos agregados do mapa e ao resumo
+static void somarParciaisTurno(ResolvedorTurno* resolvedor, ResumoTurno* resumo) {
+    AgregadosMapa* agregados = &resolvedor->mapa->agregados;
+    
+    for (int t = 0; t < resolvedor->numThreads; t++) {
+        ParcialTurno* parcial = &resolvedor->parciais[t];
+        for (int c = 0; c < MAX_CORES; c++) {
+            agregados->tropas[c] += parcial->tropas[c];
+            agregados->territorios[c] += parcial->territorios[c];
+            agregados->acimaLimite[c] += parcial->acimaLimite[c];
+            agregados->centros[c] += parcial->centros[c];
+            for (int o = 0; o < MAX_CORES; o++) {
+                agregados->posseOrigem[c][o] += parcial->posseOrigem[c][o];
+            }
+        }
+        resumo->executadas += parcial->resumo.executadas;
+        resumo->conquistas += parcial->resumo.conquistas;
+        resumo->canceladas += parcial->resumo.canceladas;
+        memset(parcial, 0, sizeof(ParcialTurno));
+    }
+    for (int c = 0; c < MAX_CORES; c++) {
+        int cores = 0;
+        for (int o = 0; o < MAX_CORES; o++) {
+            cores += agregados->posseOrigem[c][o] > 0;
+        }
+        agregados->coresOrigem[c] = cores;
+    }
+}
+
+// Função para resolver as ordens de um turno simultâneo. Ordem de resolução:
+// primeiro todas as ordens internas de cada fatia, na ordem do vetor (fatias
+// em paralelo); depois, em série, as que ligam duas fatias, também na ordem do
+// vetor. Uma ordem entre fatias, portanto, perde para qualquer ordem interna
+// sobre o mesmo território, mesmo que tenha sido dada antes. Cada ordem é
+// validada quando chega a sua vez e cai se o atacante já mudou de dono. Como
+// TERRITORIOS_POR_FATIA é fixo, a ordem não depende do número de threads.
+// Com diário, tudo roda em série
+// pelos setters, na mesma ordem e com os mesmos dados, e o turno vira uma
+// única jogada. Ordens com territórios fora do mapa são canceladas.
+ResumoTurno resolverTurnoSimultaneo(ResolvedorTurno* resolvedor, OrdemAtaque* ordens, long long total, 
+                                    uint64_t semente) {
+    Mapa* mapa = resolvedor->mapa;
+    int numFatias = resolvedor->numFatias;
+    long long* inicioBalde = resolvedor->inicioBalde;
+    ResumoTurno resumo = {0, 0, 0, 0};
+    
+    resolvedor->ordens = ordens;
+    resolvedor->semente = semente;
+    if (total > resolvedor->capacidadeBalde) {
+        long long* novos = (long long*)realloc(resolvedor->ordensBalde, total * sizeof(long long));
+        if (novos == NULL) {
+            printf("Erro: Não foi possível alocar memória para as ordens do turno!\n");
+            exit(1);
+        }
+        resolvedor->ordensBalde = novos;
+        resolvedor->capacidadeBalde = total;
+    }
+    
+    // Agrupar as ordens por fatia (ordenação por contagem, estável)
+    memset(inicioBalde, 0, (numFatias + 2) * sizeof(long long));
+    for (long long i = 0; i < total; i++) {
+        int atacante = ordens[i].atacante, defensor = ordens[i].defensor;
+        if (atacante < 0 || atacante >= mapa->quantidade || defensor < 0 || defensor >= mapa->quantidade) {
+            ordens[i].situacao = ORDEM_CANCELADA;
+            resumo.canceladas++;
+            continue;
+        }
+        int fatia = atacante / TERRITORIOS_POR_FATIA;
+        inicioBalde[(fatia == defensor / TERRITORIOS_POR_FATIA ? fatia : numFatias) + 1]++;
+    }
+    for (int b = 0; b <= numFatias; b++) {
+        inicioBalde[b + 1] += inicioBalde[b];
+    }
+    memcpy(resolvedor->posicaoBalde, inicioBalde, (numFatias + 2) * sizeof(long long));
+    for (long long i = 0; i < total; i++) {
+        int atacante = ordens[i].atacante, defensor = ordens[i].defensor;
+        if (atacante < 0 || atacante >= mapa->quantidade || defensor < 0 || defensor >= mapa->quantidade) continue;
+        int fatia = atacante / TERRITORIOS_POR_FATIA;
+        resolvedor->ordensBalde[resolvedor->posicaoBalde[fatia == defensor / TERRITORIOS_POR_FATIA 
+                                                          ? fatia : numFatias]++] = i;
+    }
+    resumo.entreFatias = inicioBalde[numFatias + 1] - inicioBalde[numFatias];
+    
+    if (mapa->diario != NULL) {
+        // Referência em série: mesma ordem de resolução, pelos setters
+        for (long long k = 0; k < inicioBalde[numFatias + 1]; k++) {
+            executarOrdem(resolvedor, resolvedor->ordensBalde[k], NULL, &resumo);
+        }
+        marcarJogada(mapa->diario);
+        return resumo;
+    }
+    
+    executarPorFatias(resolvedor->grupo, numFatias, resolverOrdensFatia, resolvedor);
+    for (long long k = inicioBalde[numFatias]; k < inicioBalde[numFatias + 1]; k++) {
+        executarOrdem(resolvedor, resolvedor->ordensBalde[k], &resolvedor->parciais[0], 
+                      &resolvedor->parciais[0].resumo);
+    }
+    executarPorFatias(resolvedor->grupo, numFatias, recontarAliadosFatia, resolvedor);
+    somarParciaisTurno(resolvedor, &resumo);
+    return resumo;
+}
+
+// Dados de trabalho de cada thread da simulação em massa
+typedef struct {
+    int tropasAtacante;
+    int tropasDefensor;
+    long long batalhas;
+    GeradorAleatorio gerador;
+    EstatisticasSimulacao parcial;
+} TarefaSimulacao;
+
+// Função executada por cada thread: resolve suas batalhas e acumula localmente
+void* executarTarefaSimulacao(void* argumento) {
+    TarefaSimulacao* tarefa = (TarefaSimulacao*)argumento;
+    EstatisticasSimulacao parcial = {0, 0, 0, 0, 0, 0};
+    GeradorAleatorio gerador = tarefa->gerador;
+    uint8_t dados[512];
+    
+    for (long long i = 0; i < tarefa->batalhas; i++) {
+        // Cada batalha parte do mesmo estado inicial do par
+        int tropasAtacante = tarefa->tropasAtacante;
+        int tropasDefensor = tarefa->tropasDefensor;
+        // Dados sorteados em blocos para evitar uma chamada por rolagem
+        int posicao = (int)(i % 256) * 2;
+        if (posicao == 0) {
+            preencherDados(&gerador, dados, sizeof(dados));
+        }
+        int dadoAtacante = dados[posicao];
+        int dadoDefensor = dados[posicao + 1];
+        
+        ResultadoBatalha resultado = resolverBatalha(&tropasAtacante, &tropasDefensor, 
+                                                     dadoAtacante, dadoDefensor);
+        if (resultado.conquistou) {
+            parcial.vitoriasAtacante++;
+            parcial.tropasTransferidas += resultado.tropasTransferidas;
+            parcial.tropasPerdidasDefensor += resultado.perdaDefensor;
+        } else {
+            parcial.vitoriasDefensor++;
+            parcial.tropasPerdidasAtacante += resultado.perdaAtacante;
+        }
+    }
+    
+    parcial.batalhas = tarefa->batalhas;
+    tarefa->parcial = parcial;
+    // Contadas por tarefa: o laço acima é curto demais para instrumentar por rodada
+    CONTAR_METRICA(CONTADOR_BATALHAS, (uint64_t)parcial.batalhas);
+    CONTAR_METRICA(CONTADOR_CONQUISTAS, (uint64_t)parcial.vitoriasAtacante);
+    return NULL;
+}
+
+// Função para descobrir quantos núcleos estão disponíveis
+int contarNucleos() {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos < 1) return 1;
+    if (nucleos > MAX_THREADS_SIMULACAO) return MAX_THREADS_SIMULACAO;
+    return (int)nucleos;
+}
+
+// Função para simular em paralelo muitas batalhas entre um par de territórios.
+// Não altera os territórios nem imprime nada; numThreads <= 0 usa todos os núcleos.
+// Retorna 1 em caso de sucesso e 0 se não foi possível criar as threads.
+int simularBatalhas(const Territorio* atacante, const Territorio* defensor, 
+                    long long numBatalhas, int numThreads, uint64_t semente, 
+                    EstatisticasSimulacao* estatisticas) {
+    pthread_t threads[MAX_THREADS_SIMULACAO];
+    TarefaSimulacao tarefas[MAX_THREADS_SIMULACAO];
+    
+    memset(estatisticas, 0, sizeof(EstatisticasSimulacao));
+    if (numBatalhas <= 0) return 1;
+    
+    if (numThreads <= 0) numThreads = contarNucleos();
+    if (numThreads > MAX_THREADS_SIMULACAO) numThreads = MAX_THREADS_SIMULACAO;
+    if (numThreads > numBatalhas) numThreads = (int)numBatalhas;
+    
+    // Dividir as batalhas igualmente entre as threads
+    for (int t = 0; t < numThreads; t++) {
+        tarefas[t].tropasAtacante = atacante->tropas;
+        tarefas[t].tropasDefensor = defensor->tropas;
+        tarefas[t].batalhas = numBatalhas / numThreads + (t < numBatalhas % numThreads ? 1 : 0);
+        inicializarGerador(&tarefas[t].gerador, semente, (uint64_t)t);
+    }
+    
+    int criadas = 0;
+    for (; criadas < numThreads; criadas++) {
+        if (pthread_create(&threads[criadas], NULL, executarTarefaSimulacao, &tarefas[criadas]) != 0) {
+            break;
+        }
+    }
+    for (int t = 0; t < criadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    if (criadas < numThreads) return 0;
+    
+    // Combinar os resultados parciais
+    for (int t = 0; t < numThreads; t++) {
+        estatisticas->batalhas += tarefas[t].parcial.batalhas;
+        estatisticas->vitoriasAtacante += tarefas[t].parcial.vitoriasAtacante;
+        estatisticas->vitoriasDefensor += tarefas[t].parcial.vitoriasDefensor;
+        estatisticas->tropasPerdidasAtacante += tarefas[t].parcial.tropasPerdidasAtacante;
+        estatisticas->tropasPerdidasDefensor += tarefas[t].parcial.tropasPerdidasDefensor;
+        estatisticas->tropasTransferidas += tarefas[t].parcial.tropasTransferidas;
+    }
+    return 1;
+}
+
+// Função para medir o tempo decorrido em segundos (relógio monotônico)
+double tempoAtual() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+// Modo de linha de comando: war --simular <tropasAtacante> <tropasDefensor> <batalhas> [threads] [semente]
+int executarModoSimulacao(int argc, char* argv[]) {
+    if (argc < 5) {
+        printf("Uso: %s --simular <tropasAtacante> <tropasDefensor> <batalhas> [threads] [semente]\n", argv[0]);
+        return 1;
+    }
+    
+    Territorio atacante = {"Atacante", "A", atoi(argv[2])};
+    Territorio defensor = {"Defensor", "D", atoi(argv[3])};
+    long long numBatalhas = atoll(argv[4]);
+    int numThreads = argc > 5 ? atoi(argv[5]) : 0;
+    uint64_t semente = argc > 6 ? strtoull(argv[6], NULL, 10) : (uint64_t)time(NULL);
+    
+    if (atacante.tropas < 2 || defensor.tropas < 1 || numBatalhas < 1) {
+        printf("Erro: o atacante precisa de pelo menos 2 tropas, o defensor de 1 e deve haver ao menos 1 batalha!\n");
+        return 1;
+    }
+    
+    EstatisticasSimulacao estatisticas;
+    double inicio = tempoAtual();
+    if (!simularBatalhas(&atacante, &defensor, numBatalhas, numThreads, semente, &estatisticas)) {
+        printf("Erro: Não foi possível criar as threads da simulação!\n");
+        return 1;
+    }
+    double duracao = tempoAtual() - inicio;
+    
+    printf("=== SIMULAÇÃO EM MASSA ===\n");
+    printf("Batalhas: %lld (%d x %d tropas)\n", estatisticas.batalhas, atacante.tropas, defensor.tropas);
+    printf("Semente: %llu\n", (unsigned long long)semente);
+    printf("Vitórias do atacante: %lld (%.2f%%)\n", estatisticas.vitoriasAtacante, 
+           100.0 * estatisticas.vitoriasAtacante / estatisticas.batalhas);
+    printf("Vitórias do defensor: %lld (%.2f%%)\n", estatisticas.vitoriasDefensor, 
+           100.0 * estatisticas.vitoriasDefensor / estatisticas.batalhas);
+    printf("Tropas perdidas pelo atacante: %lld\n", estatisticas.tropasPerdidasAtacante);
+    printf("Tropas perdidas pelo defensor: %lld\n", estatisticas.tropasPerdidasDefensor);
+    printf("Tropas transferidas em conquistas: %lld\n", estatisticas.tropasTransferidas);
+    printf("Tempo: %.3f s (%.0f batalhas/s)\n", duracao, 
+           duracao > 0 ? estatisticas.batalhas / duracao : 0.0);
+    return 0;
+}
+
+// Modo de linha de comando: war --odds <tropasAtacante> <tropasDefensor> [--distribuicao]
+int executarModoChances(int argc, char* argv[]) {
+    if (argc < 4) {
+        printf("Uso: %s --odds <tropasAtacante> <tropasDefensor> [--distribuicao] [--classico]\n", argv[0]);
+        return 1;
+    }
+    
+    int tropasAtacante = atoi(argv[2]);
+    int tropasDefensor = atoi(argv[3]);
+    int comDistribuicao = 0, classico = 0;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--distribuicao") == 0) comDistribuicao = 1;
+        else if (strcmp(argv[i], "--classico") == 0) classico = 1;
+    }
+    
+    if (tropasAtacante < 2 || tropasDefensor < 1) {
+        printf("Erro: o atacante precisa de pelo menos 2 tropas e o defensor de 1!\n");
+        return 1;
+    }
+    
+    double* conquista = NULL;
+    if (comDistribuicao) {
+        conquista = (double*)malloc((tropasAtacante + 1) * sizeof(double));
+        if (conquista == NULL) {
+            printf("Erro: Falha na alocação de memória para a distribuição!\n");
+            exit(1);
+        }
+    }
+    ChancesAtaque rodada, repetido;
+    if (classico) {
+        rodada = calcularChancesRodadaClassica(tropasAtacante, tropasDefensor);
+        repetido = calcularChancesClassicas(tropasAtacante, tropasDefensor, conquista);
+    } else {
+        rodada = calcularChancesRodada(tropasAtacante, tropasDefensor);
+        repetido = calcularChancesAteConquista(tropasAtacante, tropasDefensor);
+    }
+    
+    printf("=== CHANCES EXATAS (%d x %d tropas%s) ===\n", tropasAtacante, tropasDefensor, 
+           classico ? ", regra clássica 3x2" : "");
+    printf("Uma rolagem:\n");
+    printf("- Conquista: %.6f\n", rodada.conquista);
+    printf("- Tropas esperadas: atacante %.4f, ocupação %.4f, defensor %.4f\n", 
+           rodada.tropasAtacante, rodada.tropasOcupacao, rodada.tropasDefensor);
+    printf("Atacando até conquistar ou ficar com 1 tropa:\n");
+    printf("- Conquista: %.6f\n", repetido.conquista);
+    printf("- Tropas esperadas: atacante %.4f, ocupação %.4f, defensor %.4f\n", 
+           repetido.tropasAtacante, repetido.tropasOcupacao, repetido.tropasDefensor);
+    printf("- Rolagens esperadas: %.4f\n", repetido.rodadas);
+    
+    if (comDistribuicao) {
+        double exaustao = classico ? 1 - repetido.conquista 
+                                   : distribuirChancesAtaque(tropasAtacante, conquista);
+        printf("Distribuição (tropas na rolagem vencedora -> origem/ocupação: probabilidade):\n");
+        for (int m = tropasAtacante; m >= 2; m--) {
+            if (classico && conquista[m] == 0) continue;
+            printf("- %d -> %d/%d: %.6f\n", m, m - m / 2, m / 2, conquista[m]);
+        }
+        if (classico) {
+            printf("- exaustão (atacante com 1 tropa, defensor mantém %.4f em média): %.6f\n", 
+                   exaustao > 0 ? repetido.tropasDefensor / exaustao : 0.0, exaustao);
+        } else {
+            printf("- exaustão (atacante com 1 tropa, defensor mantém %d): %.6f\n", tropasDefensor, exaustao);
+        }
+    }
+    free(conquista);
+    return 0;
+}
+
+// Formato do snapshot binário: cabeçalho fixo seguido das seções abaixo,
+// cada uma alinhada a ALINHAMENTO_SNAPSHOT bytes. As colunas ficam no mesmo
+// formato usado em memória, então carregar é apenas mapear o arquivo.
+#define MAGICO_SNAPSHOT "WARSNAP"
+#define VERSAO_SNAPSHOT 3          // 2: vizinhos aliados e grafo de fronteiras; 3: índice de nomes
+#define MARCA_ENDIAN_SNAPSHOT 0x01020304u
+#define ALINHAMENTO_SNAPSHOT 64
+
+typedef struct {
+    char magico[8];
+    uint32_t versao;
+    uint32_t marcaEndian;           // Detecta arquivos gerados em outra arquitetura
+    uint32_t tamanhoCabecalho;
+    uint32_t tamanhoJogador;
+    int32_t quantidade;             // Territórios
+    int32_t numJogadores;
+    int32_t vencedor;
+    uint32_t capacidadeIndice;      // Posições do índice de nomes
+    uint64_t semente;
+    int64_t ataques;
+    uint64_t tamanhoPool;
+    int64_t entradasVizinhos;       // Tamanho do vetor de vizinhos (-1 se não há grafo)
+    GeradorAleatorio gerador;
+    RegistroCores cores;
+    AgregadosMapa agregados;
+    uint64_t posicaoJogadores;      // Posições das seções a partir do início do arquivo
+    uint64_t posicaoCor;
+    uint64_t posicaoCorOriginal;
+    uint64_t posicaoTropas;
+    uint64_t posicaoNome;
+    uint64_t posicaoPool;
+    uint64_t posicaoAliados;
+    uint64_t posicaoIndiceNomes;
+    uint64_t posicaoInicioVizinhos;
+    uint64_t posicaoVizinhos;
+    uint64_t tamanhoArquivo;
+} CabecalhoSnapshot;
+
+// Função auxiliar para arredondar uma posição ao alinhamento das seções
+static uint64_t alinharSnapshot(uint64_t posicao) {
+    return (posicao + ALINHAMENTO_SNAPSHOT - 1) & ~(uint64_t)(ALINHAMENTO_SNAPSHOT - 1);
+}
+
+// Função auxiliar para gravar uma seção na posição indicada (preenche o espaço com zeros)
+static int gravarSecao(FILE* arquivo, uint64_t* posicaoAtual, uint64_t posicao, 
+                       const void* dados, size_t tamanho) {
+    static const char zeros[ALINHAMENTO_SNAPSHOT] = {0};
+    if (posicao > *posicaoAtual && 
+        fwrite(zeros, 1, posicao - *posicaoAtual, arquivo) != posicao - *posicaoAtual) {
+        return 0;
+    }
+    if (tamanho > 0 && fwrite(dados, 1, tamanho, arquivo) != tamanho) return 0;
+    *posicaoAtual = posicao + tamanho;
+    return 1;
+}
+
+// Função para salvar a partida (mapa, jogadores, missões e gerador) em um snapshot.
+// Grava em um arquivo temporário e renomeia, para nunca deixar um snapshot pela metade.
+// Retorna 1 em caso de sucesso e 0 em caso de erro.
+int salvarSnapshot(const Jogo* jogo, const char* caminho) {
+    const Mapa* mapa = &jogo->mapa;
+    CabecalhoSnapshot cabecalho;
+    size_t quantidade = (size_t)mapa->quantidade;
+    
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magico, MAGICO_SNAPSHOT, sizeof(MAGICO_SNAPSHOT));
+    cabecalho.versao = VERSAO_SNAPSHOT;
+    cabecalho.marcaEndian = MARCA_ENDIAN_SNAPSHOT;
+    cabecalho.tamanhoCabecalho = sizeof(CabecalhoSnapshot);
+    cabecalho.tamanhoJogador = sizeof(Jogador);
+    cabecalho.quantidade = mapa->quantidade;
+    cabecalho.numJogadores = jogo->numJogadores;
+    cabecalho.vencedor = jogo->vencedor;
+    cabecalho.capacidadeIndice = mapa->capacidadeIndice;
+    cabecalho.semente = jogo->semente;
+    cabecalho.ataques = jogo->ataques;
+    cabecalho.tamanhoPool = mapa->tamanhoPool;
+    cabecalho.entradasVizinhos = mapa->vizinhos != NULL ? mapa->inicioVizinhos[quantidade] : -1;
+    cabecalho.gerador = jogo->gerador;
+    cabecalho.cores = mapa->cores;
+    cabecalho.agregados = mapa->agregados;
+    
+    cabecalho.posicaoJogadores = alinharSnapshot(sizeof(CabecalhoSnapshot));
+    cabecalho.posicaoCor = alinharSnapshot(cabecalho.posicaoJogadores + 
+                                           (uint64_t)jogo->numJogadores * sizeof(Jogador));
+    cabecalho.posicaoCorOriginal = alinharSnapshot(cabecalho.posicaoCor + quantidade);
+    cabecalho.posicaoTropas = alinharSnapshot(cabecalho.posicaoCorOriginal + quantidade);
+    cabecalho.posicaoNome = alinharSnapshot(cabecalho.posicaoTropas + quantidade * sizeof(int));
+    cabecalho.posicaoPool = alinharSnapshot(cabecalho.posicaoNome + quantidade * sizeof(uint32_t));
+    cabecalho.posicaoAliados = alinharSnapshot(cabecalho.posicaoPool + mapa->tamanhoPool);
+    cabecalho.posicaoIndiceNomes = alinharSnapshot(cabecalho.posicaoAliados + quantidade * sizeof(int));
+    cabecalho.posicaoInicioVizinhos = alinharSnapshot(cabecalho.posicaoIndiceNomes + 
+                                                      (uint64_t)mapa->capacidadeIndice * sizeof(uint64_t));
+    size_t tamanhoInicio = mapa->vizinhos != NULL ? (quantidade + 1) * sizeof(int64_t) : 0;
+    size_t tamanhoVizinhos = mapa->vizinhos != NULL 
+                             ? (size_t)cabecalho.entradasVizinhos * sizeof(int) : 0;
+    cabecalho.posicaoVizinhos = alinharSnapshot(cabecalho.posicaoInicioVizinhos + tamanhoInicio);
+    cabecalho.tamanhoArquivo = cabecalho.posicaoVizinhos + tamanhoVizinhos;
+    
+    char temporario[4096];
+    int escritos = snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    if (escritos < 0 || (size_t)escritos >= sizeof(temporario)) return 0;
+    FILE* arquivo = fopen(temporario, "wb");
+    if (arquivo == NULL) return 0;
+    
+    uint64_t posicao = 0;
+    int ok = gravarSecao(arquivo, &posicao, 0, &cabecalho, sizeof(cabecalho)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoJogadores, jogo->jogadores, 
+                         (size_t)jogo->numJogadores * sizeof(Jogador)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoCor, mapa->cor, quantidade) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoCorOriginal, mapa->corOriginal, quantidade) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoTropas, mapa->tropas, 
+                         quantidade * sizeof(int)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoNome, mapa->nome, 
+                         quantidade * sizeof(uint32_t)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoPool, mapa->poolNomes, mapa->tamanhoPool) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoAliados, mapa->aliados, 
+                         quantidade * sizeof(int)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoIndiceNomes, mapa->indiceNomes, 
+                         (size_t)mapa->capacidadeIndice * sizeof(uint64_t)) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoInicioVizinhos, mapa->inicioVizinhos, 
+                         tamanhoInicio) &&
+             gravarSecao(arquivo, &posicao, cabecalho.posicaoVizinhos, mapa->vizinhos, tamanhoVizinhos);
+    
+    if (fclose(arquivo) != 0) ok = 0;
+    if (!ok || rename(temporario, caminho) != 0) {
+        remove(temporario);
+        return 0;
+    }
+    return 1;
+}
+
+// Função auxiliar: 1 se a seção [posicao, posicao + tamanhoSecao) está alinhada
+// e cabe no arquivo. Compara pela diferença para que somas não estourem.
+static int secaoCabe(uint64_t posicao, uint64_t tamanhoSecao, uint64_t tamanho) {
+    return posicao % ALINHAMENTO_SNAPSHOT == 0 && posicao <= tamanho && tamanhoSecao <= tamanho - posicao;
+}
+
+// Função para validar o conteúdo das seções de um snapshot (os limites já foram
+// conferidos): jogadores e missões, cores e nomes dos territórios, índice de
+// nomes e grafo. Por fim os vizinhos aliados e os agregados do cabeçalho são
+// recalculados a partir das colunas e têm que coincidir. Retorna 1 se tudo é válido.
+static int validarConteudoSnapshot(const uint8_t* base, const CabecalhoSnapshot* cabecalho) {
+    const RegistroCores* cores = &cabecalho->cores;
+    const Jogador* jogadores = (const Jogador*)(base + cabecalho->posicaoJogadores);
+    const int* tropas = (const int*)(base + cabecalho->posicaoTropas);
+    const uint32_t* nome = (const uint32_t*)(base + cabecalho->posicaoNome);
+    const int* aliados = (const int*)(base + cabecalho->posicaoAliados);
+    const uint64_t* indice = (const uint64_t*)(base + cabecalho->posicaoIndiceNomes);
+    int quantidade = cabecalho->quantidade;
+    
+    // Cores e jogadores: todo ID de cor tem que estar registrado
+    for (int c = 0; c < cores->total; c++) {
+        if (memchr(cores->nomes[c], '\0', sizeof(cores->nomes[c])) == NULL) return 0;
+    }
+    if (cabecalho->vencedor < -1 || cabecalho->vencedor >= cabecalho->numJogadores) return 0;
+    for (int j = 0; j < cabecalho->numJogadores; j++) {
+        const Missao* missao = &jogadores[j].missao;
+        if (memchr(jogadores[j].nome, '\0', sizeof(jogadores[j].nome)) == NULL || 
+            jogadores[j].cor >= cores->total || 
+            (unsigned)missao->tipo >= TOTAL_TIPOS_MISSAO || 
+            missao->definicao < 0 || missao->definicao >= TOTAL_MISSOES || 
+            missao->corAlvo < -1 || missao->corAlvo >= cores->total || 
+            missao->territorioAlvo < -1 || missao->territorioAlvo >= quantidade) {
+            return 0;
+        }
+        // A missão tem que ser a da tabela (descreverMissao usa o formato do
+        // tipo com o alvo da definição), com alvos só nos tipos que os usam
+        const DefinicaoMissao* definicao = &missoesPredefinidas[missao->definicao];
+        if (missao->tipo != definicao->tipo || missao->parametro != definicao->parametro || 
+            (missao->tipo != MISSAO_ELIMINAR_COR && missao->corAlvo != -1) || 
+            (missao->tipo != MISSAO_TERRITORIO && missao->territorioAlvo != -1) || 
+            (missao->corAlvo >= 0 && strcasecmp(cores->nomes[missao->corAlvo], definicao->alvo) != 0)) {
+            return 0;
+        }
+    }
+    
+    // Colunas dos territórios
+    Mapa mapa;
+    memset(&mapa, 0, sizeof(mapa));
+    mapa.quantidade = quantidade;
+    mapa.cor = (uint8_t*)(base + cabecalho->posicaoCor);
+    mapa.corOriginal = (uint8_t*)(base + cabecalho->posicaoCorOriginal);
+    for (int t = 0; t < quantidade; t++) {
+        if (mapa.cor[t] >= cores->total || mapa.corOriginal[t] >= cores->total || 
+            nome[t] >= cabecalho->tamanhoPool || tropas[t] < 0) {
+            return 0;
+        }
+    }
+    // Território alvo (nomes já validados): o de nome igual ao da definição
+    const char* pool = (const char*)(base + cabecalho->posicaoPool);
+    for (int j = 0; j < cabecalho->numJogadores; j++) {
+        const Missao* missao = &jogadores[j].missao;
+        if (missao->territorioAlvo >= 0 && 
+            strcmp(pool + nome[missao->territorioAlvo], missoesPredefinidas[missao->definicao].alvo) != 0) {
+            return 0;
+        }
+    }
+    
+    // Índice de nomes: cada posição ocupada aponta para um território, e sobra
+    // posição livre para que a sondagem sempre termine
+    int64_t ocupadas = 0;
+    for (uint32_t p = 0; p < cabecalho->capacidadeIndice; p++) {
+        uint32_t territorio = (uint32_t)indice[p];
+        if (indice[p] == 0) continue;
+        if (territorio == 0 || territorio > (uint32_t)quantidade) return 0;
+        ocupadas++;
+    }
+    if (ocupadas > quantidade) return 0;
+    
+    // Grafo em CSR: começa em 0, cresce, termina nas entradas, e cada lista de
+    // vizinhos é estritamente crescente e dentro do mapa
+    if (cabecalho->entradasVizinhos >= 0) {
+        mapa.inicioVizinhos = (int64_t*)(base + cabecalho->posicaoInicioVizinhos);
+        mapa.vizinhos = (int*)(base + cabecalho->posicaoVizinhos);
+        if (mapa.inicioVizinhos[0] != 0 || mapa.inicioVizinhos[quantidade] != cabecalho->entradasVizinhos) {
+            return 0;
+        }
+        for (int t = 0; t < quantidade; t++) {
+            if (mapa.inicioVizinhos[t + 1] < mapa.inicioVizinhos[t]) return 0;
+            for (int64_t k = mapa.inicioVizinhos[t]; k < mapa.inicioVizinhos[t + 1]; k++) {
+                if (mapa.vizinhos[k] < 0 || mapa.vizinhos[k] >= quantidade || 
+                    (k > mapa.inicioVizinhos[t] && mapa.vizinhos[k] <= mapa.vizinhos[k - 1])) {
+                    return 0;
+                }
+            }
+        }
+    }
+    
+    // Agregados e vizinhos aliados recalculados das colunas
+    AgregadosMapa agregados;
+    memset(&agregados, 0, sizeof(agregados));
+    for (int t = 0; t < quantidade; t++) {
+        uint8_t dono = mapa.cor[t];
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(&mapa, t, &vizinhos, implicitos);
+        int vizinhosAliados = 0;
+        for (int i = 0; i < grau; i++) {
+            vizinhosAliados += mapa.cor[vizinhos[i]] == dono;
+        }
+        if (aliados[t] != vizinhosAliados) return 0;
+        if (vizinhosAliados >= 2) agregados.centros[dono]++;
+        if (agregados.posseOrigem[dono][mapa.corOriginal[t]]++ == 0) agregados.coresOrigem[dono]++;
+        agregados.territorios[dono]++;
+        agregados.tropas[dono] += tropas[t];
+        agregados.acimaLimite[dono] += tropas[t] > LIMITE_TROPAS_MISSAO;
+    }
+    return memcmp(&agregados, &cabecalho->agregados, sizeof(AgregadosMapa)) == 0;
+}
+
+// Função para carregar um snapshot em uma partida vazia. O arquivo é mapeado
+// com mmap (cópia privada) e as colunas do mapa apontam direto para ele, sem
+// nenhuma etapa de leitura ou conversão. Retorna 1 em caso de sucesso e 0 em caso de erro.
+int carregarSnapshot(Jogo* jogo, const char* caminho) {
+    Arena* arena = jogo->mapa.arena;
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) return 0;
+    
+    struct stat info;
+    if (fstat(descritor, &info) != 0 || (size_t)info.st_size < sizeof(CabecalhoSnapshot)) {
+        close(descritor);
+        return 0;
+    }
+    size_t tamanho = (size_t)info.st_size;
+    uint8_t* base = (uint8_t*)mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE, descritor, 0);
+    close(descritor);
+    if (base == MAP_FAILED) return 0;
+    
+    // Validar cabeçalho e limites das seções; depois, o conteúdo de cada uma
+    const CabecalhoSnapshot* cabecalho = (const CabecalhoSnapshot*)base;
+    uint64_t quantidade = cabecalho->quantidade >= 0 ? (uint64_t)cabecalho->quantidade : 0;
+    int possuiGrafo = cabecalho->entradasVizinhos >= 0;
+    uint64_t entradas = possuiGrafo ? (uint64_t)cabecalho->entradasVizinhos : 0;
+    int valido = memcmp(cabecalho->magico, MAGICO_SNAPSHOT, sizeof(MAGICO_SNAPSHOT)) == 0 &&
+                 cabecalho->versao == VERSAO_SNAPSHOT &&
+                 cabecalho->marcaEndian == MARCA_ENDIAN_SNAPSHOT &&
+                 cabecalho->tamanhoCabecalho == sizeof(CabecalhoSnapshot) &&
+                 cabecalho->tamanhoJogador == sizeof(Jogador) &&
+                 cabecalho->quantidade >= 0 && cabecalho->numJogadores >= 0 &&
+                 cabecalho->cores.total >= 0 && cabecalho->cores.total <= MAX_CORES &&
+                 cabecalho->tamanhoArquivo == tamanho &&
+                 secaoCabe(cabecalho->posicaoJogadores, (uint64_t)cabecalho->numJogadores * sizeof(Jogador), tamanho) &&
+                 secaoCabe(cabecalho->posicaoCor, quantidade, tamanho) &&
+                 secaoCabe(cabecalho->posicaoCorOriginal, quantidade, tamanho) &&
+                 secaoCabe(cabecalho->posicaoTropas, quantidade * sizeof(int), tamanho) &&
+                 secaoCabe(cabecalho->posicaoNome, quantidade * sizeof(uint32_t), tamanho) &&
+                 secaoCabe(cabecalho->posicaoPool, cabecalho->tamanhoPool, tamanho) &&
+                 secaoCabe(cabecalho->posicaoAliados, quantidade * sizeof(int), tamanho) &&
+                 cabecalho->capacidadeIndice > 0 && cabecalho->capacidadeIndice >= quantidade + quantidade / 2 &&
+                 (cabecalho->capacidadeIndice & (cabecalho->capacidadeIndice - 1)) == 0 &&
+                 secaoCabe(cabecalho->posicaoIndiceNomes, (uint64_t)cabecalho->capacidadeIndice * sizeof(uint64_t), 
+                           tamanho) &&
+                 (!possuiGrafo || 
+                  (entradas <= tamanho / sizeof(int) &&
+                   secaoCabe(cabecalho->posicaoInicioVizinhos, (quantidade + 1) * sizeof(int64_t), tamanho) &&
+                   secaoCabe(cabecalho->posicaoVizinhos, entradas * sizeof(int), tamanho))) &&
+                 (cabecalho->tamanhoPool == 0 || base[cabecalho->posicaoPool + cabecalho->tamanhoPool - 1] == '\0') &&
+                 validarConteudoSnapshot(base, cabecalho);
+    
+    // Os jogadores são copiados (são poucos e podem crescer); as colunas não
+    Jogador* jogadores = NULL;
+    if (valido && cabecalho->numJogadores > 0) {
+        jogadores = (Jogador*)alocarMemoriaJogo(arena, (size_t)cabecalho->numJogadores * sizeof(Jogador));
+        valido = jogadores != NULL;
+    }
+    if (!valido) {
+        munmap(base, tamanho);
+        return 0;
+    }
+    memcpy(jogadores, base + cabecalho->posicaoJogadores, 
+           (size_t)cabecalho->numJogadores * sizeof(Jogador));
+    
+    iniciarJogo(jogo, cabecalho->semente);
+    jogo->mapa.arena = arena;
+    jogo->jogadores = jogadores;
+    jogo->numJogadores = cabecalho->numJogadores;
+    jogo->capacidadeJogadores = cabecalho->numJogadores;
+    jogo->vencedor = cabecalho->vencedor;
+    jogo->ataques = cabecalho->ataques;
+    jogo->gerador = cabecalho->gerador;
+    
+    Mapa* mapa = &jogo->mapa;
+    mapa->quantidade = cabecalho->quantidade;
+    mapa->capacidade = cabecalho->quantidade;
+    mapa->cor = base + cabecalho->posicaoCor;
+    mapa->corOriginal = base + cabecalho->posicaoCorOriginal;
+    mapa->tropas = (int*)(base + cabecalho->posicaoTropas);
+    mapa->nome = (uint32_t*)(base + cabecalho->posicaoNome);
+    mapa->poolNomes = (char*)(base + cabecalho->posicaoPool);
+    mapa->aliados = (int*)(base + cabecalho->posicaoAliados);
+    mapa->indiceNomes = (uint64_t*)(base + cabecalho->posicaoIndiceNomes);
+    mapa->capacidadeIndice = cabecalho->capacidadeIndice;
+    if (possuiGrafo) {
+        mapa->inicioVizinhos = (int64_t*)(base + cabecalho->posicaoInicioVizinhos);
+        mapa->vizinhos = (int*)(base + cabecalho->posicaoVizinhos);
+    }
+    mapa->tamanhoPool = cabecalho->tamanhoPool;
+    mapa->capacidadePool = cabecalho->tamanhoPool;
+    mapa->cores = cabecalho->cores;
+    mapa->agregados = cabecalho->agregados;
+    mapa->mapeamento = base;
+    mapa->tamanhoMapeamento = tamanho;
+    return 1;
+}
+
+// Fases da leitura de um roteiro de partidas em lote
+typedef enum {
+    LOTE_AGUARDANDO,        // Esperando "jogadores N" para começar uma partida
+    LOTE_JOGADORES,         // Lendo linhas "<nome> <cor>"
+    LOTE_TERRITORIOS,       // Lendo linhas "<nome> <cor> <tropas>"
+    LOTE_FRONTEIRAS,        // Lendo linhas "<territorio> <territorio>"
+    LOTE_JOGANDO,           // Lendo comandos da partida
+    LOTE_DESCARTANDO        // Partida encerrada ou com erro; ignora até a próxima
+} FaseLote;
+
+// Estado do processador de roteiros em lote
+typedef struct {
+    Jogo* jogo;                 // Partida atual, no início da arena
+    Arena arena;                // Reiniciada a cada "jogadores N"
+    DiarioJogadas diario;       // Esvaziado a cada partida
+    FaseLote fase;
+    int pendentes;              // Linhas de cadastro que ainda faltam na fase atual
+    int numeroJogo;             // Partidas iniciadas no roteiro
+    int jogoAberto;             // 1 se há uma partida sem resultado publicado
+    uint64_t sementeBase;       // Semente padrão: sementeBase + número da partida
+    uint64_t proximaSemente;    // Definida pelo comando "semente"
+    int sementeDefinida;
+    int exibirEventos;          // Emite uma linha compacta por ataque
+    FILE* saida;
+    long long linha;
+    int* pares;                 // Fronteiras lidas, antes de montar o grafo
+    int64_t totalPares;
+    OrdemAtaque* ordens;        // Ordens guardadas para o próximo "turno"
+    long long totalOrdens;
+    long long capacidadeOrdens;
+} ProcessadorLote;
+
+// Função para separar o próximo token de uma linha (termina o token com \0)
+char* proximoToken(char** cursor) {
+    char* p = *cursor;
+    while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+    if (*p == '\0' || *p == '#') {
+        *cursor = p;
+        return NULL;
+    }
+    char* inicio = p;
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r') p++;
+    if (*p != '\0') *p++ = '\0';
+    *cursor = p;
+    return inicio;
+}
+
+// Função para converter um token em inteiro, recusando texto extra
+int converterInteiro(const char* token, long long* valor) {
+    char* fim;
+    if (token == NULL) return 0;
+    *valor = strtoll(token, &fim, 10);
+    return fim != token && *fim == '\0';
+}
+
+// Função para publicar o resultado da partida atual (uma linha por partida)
+void publicarResultadoLote(ProcessadorLote* lote) {
+    Jogo* jogo = lote->jogo;
+    if (!lote->jogoAberto) return;
+    registrarFimLog(jogo);
+    
+    if (jogo->vencedor >= 0) {
+        const Jogador* vencedor = &jogo->jogadores[jogo->vencedor];
+        fprintf(lote->saida, "jogo %d semente %llu vencedor %s %s missao %d ataques %lld\n", 
+                lote->numeroJogo, (unsigned long long)jogo->semente, vencedor->nome, 
+                nomeCor(&jogo->mapa.cores, vencedor->cor), vencedor->missao.definicao + 1, 
+                jogo->ataques);
+    } else {
+        fprintf(lote->saida, "jogo %d semente %llu sem_vencedor ataques %lld\n", 
+                lote->numeroJogo, (unsigned long long)jogo->semente, jogo->ataques);
+    }
+    lote->jogoAberto = 0;
+}
+
+// Função para registrar um erro no roteiro e descartar o restante da partida
+void falharLote(ProcessadorLote* lote, const char* mensagem) {
+    if (lote->jogoAberto) {
+        fprintf(lote->saida, "jogo %d erro linha %lld: %s\n", 
+                lote->numeroJogo, lote->linha, mensagem);
+        lote->jogoAberto = 0;
+    } else {
+        fprintf(lote->saida, "erro linha %lld: %s\n", lote->linha, mensagem);
+    }
+    lote->fase = LOTE_DESCARTANDO;
+}
+
+// Função para ler um território de um token: posição (1 a N) ou nome
+int lerTerritorioLote(ProcessadorLote* lote, const char* token) {
+    return interpretarTerritorio(&lote->jogo->mapa, token);
+}
+
+// Função para executar o comando "ataque <atacante> <defensor>" de um roteiro
+void executarAtaqueLote(ProcessadorLote* lote, char** cursor) {
+    Jogo* jogo = lote->jogo;
+    int atacante = lerTerritorioLote(lote, proximoToken(cursor));
+    int defensor = lerTerritorioLote(lote, proximoToken(cursor));
+    
+    if (atacante < 0 || defensor < 0) {
+        falharLote(lote, "territorio invalido no ataque");
+        return;
+    }
+    MotivoAtaque motivo = analisarAtaque(&jogo->mapa, atacante, defensor);
+    if (motivo != ATAQUE_VALIDO) {
+        if (lote->exibirEventos) {
+            fprintf(lote->saida, "R %d %d %d\n", atacante + 1, defensor + 1, (int)motivo);
+        }
+        return; // Ataques inválidos são recusados, como no menu
+    }
+    
+    int dadoAtacante = rolarDado(&jogo->gerador);
+    int dadoDefensor = rolarDado(&jogo->gerador);
+    ResultadoBatalha resultado = resolverAtaque(&jogo->mapa, atacante, defensor, 
+                                                dadoAtacante, dadoDefensor);
+    jogo->ataques++;
+    
+    if (lote->exibirEventos) {
+        fprintf(lote->saida, "A %d %d %d %d %c %d %d\n", atacante + 1, defensor + 1, 
+                dadoAtacante, dadoDefensor, resultado.conquistou ? 'C' : 'D', 
+                jogo->mapa.tropas[atacante], jogo->mapa.tropas[defensor]);
+    }
+    
+    jogo->vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+    if (jogo->vencedor >= 0) {
+        publicarResultadoLote(lote);
+        lote->fase = LOTE_DESCARTANDO;
+    }
+}
+
+// Função para executar o comando "blitz <atacante> <defensor> [rodadas] [classico]":
+// um ataque relâmpago com no máximo 'rodadas' rolagens (0 ou ausente: sem limite)
+void executarBlitzLote(ProcessadorLote* lote, char** cursor) {
+    Jogo* jogo = lote->jogo;
+    int atacante = lerTerritorioLote(lote, proximoToken(cursor));
+    int defensor = lerTerritorioLote(lote, proximoToken(cursor));
+    RegraDados regra = DADOS_UM_A_UM;
+    long long maxRodadas = 0;
+    
+    for (char* token = proximoToken(cursor); token != NULL; token = proximoToken(cursor)) {
+        if (strcmp(token, "classico") == 0) {
+            regra = DADOS_CLASSICOS;
+        } else if (!converterInteiro(token, &maxRodadas) || maxRodadas < 0 || maxRodadas > 1000000000) {
+            falharLote(lote, "esperado 'blitz <atacante> <defensor> [rodadas] [classico]'");
+            return;
+        }
+    }
+    if (atacante < 0 || defensor < 0) {
+        falharLote(lote, "territorio invalido no ataque");
+        return;
+    }
+    MotivoAtaque motivo = analisarAtaque(&jogo->mapa, atacante, defensor);
+    if (motivo != ATAQUE_VALIDO) {
+        if (lote->exibirEventos) {
+            fprintf(lote->saida, "R %d %d %d\n", atacante + 1, defensor + 1, (int)motivo);
+        }
+        return;
+    }
+    
+    ResultadoBlitz resultado = resolverBlitz(&jogo->mapa, atacante, defensor, &jogo->gerador, 
+                                             regra, (int)maxRodadas);
+    jogo->ataques += resultado.rodadas;
+    
+    if (lote->exibirEventos) {
+        fprintf(lote->saida, "B %d %d %d %c %d %d\n", atacante + 1, defensor + 1, resultado.rodadas, 
+                resultado.conquistou ? 'C' : 'D', 
+                jogo->mapa.tropas[atacante], jogo->mapa.tropas[defensor]);
+    }
+    
+    // Uma única verificação de vitória para todas as rodadas
+    jogo->vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+    if (jogo->vencedor >= 0) {
+        publicarResultadoLote(lote);
+        lote->fase = LOTE_DESCARTANDO;
+    }
+}
+
+// Função para executar o comando "ordem <jogador> <atacante> <defensor>": guarda
+// a ordem para o próximo "turno" (a validação é feita na resolução)
+void registrarOrdemLote(ProcessadorLote* lote, char** cursor) {
+    Jogo* jogo = lote->jogo;
+    long long jogador;
+    
+    if (!converterInteiro(proximoToken(cursor), &jogador) || jogador < 1 || jogador > jogo->numJogadores) {
+        falharLote(lote, "esperado 'ordem <jogador> <atacante> <defensor>'");
+        return;
+    }
+    int atacante = lerTerritorioLote(lote, proximoToken(cursor));
+    int defensor = lerTerritorioLote(lote, proximoToken(cursor));
+    if (atacante < 0 || defensor < 0) {
+        falharLote(lote, "territorio invalido na ordem");
+        return;
+    }
+    if (lote->totalOrdens == lote->capacidadeOrdens) {
+        long long novaCapacidade = lote->capacidadeOrdens > 0 ? lote->capacidadeOrdens * 2 : 64;
+        OrdemAtaque* novas = (OrdemAtaque*)realloc(lote->ordens, novaCapacidade * sizeof(OrdemAtaque));
+        if (novas == NULL) {
+            falharLote(lote, "sem memoria para ordens");
+            return;
+        }
+        lote->ordens = novas;
+        lote->capacidadeOrdens = novaCapacidade;
+    }
+    OrdemAtaque* ordem = &lote->ordens[lote->totalOrdens++];
+    ordem->atacante = atacante;
+    ordem->defensor = defensor;
+    ordem->cor = jogo->jogadores[jogador - 1].cor;
+    ordem->situacao = ORDEM_CANCELADA;
+}
+
+// Função para executar o comando "turno": resolve de uma vez as ordens
+// guardadas, como uma única jogada, com uma verificação de vitória no fim
+void executarTurnoLote(ProcessadorLote* lote) {
+    Jogo* jogo = lote->jogo;
+    ResolvedorTurno resolvedor;
+    
+    if (!criarResolvedorTurno(&resolvedor, &jogo->mapa, 1)) {
+        liberarResolvedorTurno(&resolvedor);
+        falharLote(lote, "sem memoria para o turno");
+        return;
+    }
+    // A semente do turno sai do gerador da partida: o roteiro continua reproduzível
+    ResumoTurno resumo = resolverTurnoSimultaneo(&resolvedor, lote->ordens, lote->totalOrdens, 
+                                                 proximoAleatorio(&jogo->gerador));
+    liberarResolvedorTurno(&resolvedor);
+    jogo->ataques += resumo.executadas;
+    
+    if (lote->exibirEventos) {
+        static const char situacoes[] = {'X', 'D', 'C'};
+        for (long long i = 0; i < lote->totalOrdens; i++) {
+            const OrdemAtaque* ordem = &lote->ordens[i];
+            fprintf(lote->saida, "O %d %d %c\n", ordem->atacante + 1, ordem->defensor + 1, 
+                    situacoes[ordem->situacao]);
+        }
+        fprintf(lote->saida, "S %lld %lld %lld %lld\n", lote->totalOrdens, resumo.executadas, 
+                resumo.conquistas, resumo.canceladas);
+    }
+    lote->totalOrdens = 0;
+    
+    jogo->vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+    if (jogo->vencedor >= 0) {
+        publicarResultadoLote(lote);
+        lote->fase = LOTE_DESCARTANDO;
+    }
+}
+
+// Função para interpretar uma linha de um roteiro em lote
+static void interpretarLinhaLote(ProcessadorLote* lote, char* linha) {
+    Jogo* jogo = lote->jogo;
+    char* cursor = linha;
+    char* comando = proximoToken(&cursor);
+    long long valor;
+    
+    lote->linha++;
+    if (comando == NULL) return; // Linha vazia ou comentário
+    
+    // Comandos aceitos em qualquer fase
+    if (strcmp(comando, "semente") == 0) {
+        if (!converterInteiro(proximoToken(&cursor), &valor)) {
+            falharLote(lote, "semente invalida");
+            return;
+        }
+        lote->proximaSemente = (uint64_t)valor;
+        lote->sementeDefinida = 1;
+        return;
+    }
+    if (strcmp(comando, "jogadores") == 0) {
+        publicarResultadoLote(lote);
+        encerrarJogo(jogo);
+        
+        lote->numeroJogo++;
+        jogo = lote->jogo = criarJogoNaArena(&lote->arena, lote->sementeDefinida ? lote->proximaSemente 
+                                                 : lote->sementeBase + (uint64_t)lote->numeroJogo);
+        limparDiario(&lote->diario);
+        jogo->mapa.diario = &lote->diario;
+        lote->totalOrdens = 0;
+        lote->sementeDefinida = 0;
+        lote->jogoAberto = 1;
+        
+        if (!converterInteiro(proximoToken(&cursor), &valor) || valor < 2 || valor > MAX_CORES) {
+            falharLote(lote, "numero de jogadores invalido");
+            return;
+        }
+        lote->pendentes = (int)valor;
+        lote->fase = LOTE_JOGADORES;
+        return;
+    }
+    if (strcmp(comando, "fim") == 0) {
+        publicarResultadoLote(lote);
+        lote->fase = LOTE_AGUARDANDO;
+        return;
+    }
+    
+    switch (lote->fase) {
+        case LOTE_JOGADORES: {
+            char* cor = proximoToken(&cursor);
+            if (cor == NULL || strlen(comando) >= sizeof(jogo->jogadores[0].nome) || 
+                strlen(cor) >= sizeof(jogo->mapa.cores.nomes[0])) {
+                falharLote(lote, "jogador deve ser '<nome> <cor>'");
+                return;
+            }
+            if (buscarCor(&jogo->mapa.cores, cor) < 0 && jogo->mapa.cores.total >= MAX_CORES - 1) {
+                falharLote(lote, "cores demais");
+                return;
+            }
+            if (adicionarJogador(jogo, comando, cor) == NULL) {
+                falharLote(lote, "sem memoria para jogadores");
+                return;
+            }
+            if (--lote->pendentes == 0) lote->fase = LOTE_TERRITORIOS;
+            return;
+        }
+        
+        case LOTE_TERRITORIOS:
+            if (jogo->mapa.capacidade == 0) {
+                // Primeira linha da fase: "territorios M"
+                if (strcmp(comando, "territorios") != 0 || 
+                    !converterInteiro(proximoToken(&cursor), &valor) || 
+                    valor < jogo->numJogadores || valor > 100000000) {
+                    falharLote(lote, "esperado 'territorios M' com M >= jogadores");
+                    return;
+                }
+                if (!reservarTerritorios(&jogo->mapa, (int)valor)) {
+                    falharLote(lote, "sem memoria para territorios");
+                    return;
+                }
+                lote->pendentes = (int)valor;
+                return;
+            } else {
+                Territorio territorio;
+                char* cor = proximoToken(&cursor);
+                if (cor == NULL || !converterInteiro(proximoToken(&cursor), &valor) || valor < 1 || 
+                    strlen(comando) >= sizeof(territorio.nome) || strlen(cor) >= sizeof(territorio.cor)) {
+                    falharLote(lote, "territorio deve ser '<nome> <cor> <tropas>' com tropas >= 1");
+                    return;
+                }
+                if (buscarCor(&jogo->mapa.cores, cor) < 0 && jogo->mapa.cores.total >= MAX_CORES) {
+                    falharLote(lote, "cores demais");
+                    return;
+                }
+                memcpy(territorio.nome, comando, strlen(comando) + 1);
+                memcpy(territorio.cor, cor, strlen(cor) + 1);
+                territorio.tropas = (int)valor;
+                if (adicionarTerritorio(&jogo->mapa, &territorio) < 0) {
+                    falharLote(lote, "nome de territorio repetido");
+                    return;
+                }
+                
+                if (--lote->pendentes == 0) {
+                    resolverAlvosMissoes(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+                    lote->fase = LOTE_JOGANDO;
+                }
+                return;
+            }
+        
+        case LOTE_FRONTEIRAS: {
+            // Cada linha é um par "<territorio> <territorio>" (1 a N)
+            int a = lerTerritorioLote(lote, comando);
+            int b = lerTerritorioLote(lote, proximoToken(&cursor));
+            if (a < 0 || b < 0) {
+                falharLote(lote, "fronteira deve ser '<territorio> <territorio>'");
+                return;
+            }
+            lote->pares[2 * lote->totalPares] = a;
+            lote->pares[2 * lote->totalPares + 1] = b;
+            lote->totalPares++;
+            if (--lote->pendentes == 0) {
+                int ok = construirGrafo(&jogo->mapa, lote->pares, lote->totalPares);
+                free(lote->pares);
+                lote->pares = NULL;
+                if (!ok) {
+                    falharLote(lote, "sem memoria para o grafo");
+                    return;
+                }
+                lote->fase = LOTE_JOGANDO;
+            }
+            return;
+        }
+        
+        case LOTE_JOGANDO:
+            if (strcmp(comando, "ataque") == 0) {
+                executarAtaqueLote(lote, &cursor);
+            } else if (strcmp(comando, "blitz") == 0) {
+                executarBlitzLote(lote, &cursor);
+            } else if (strcmp(comando, "ordem") == 0) {
+                registrarOrdemLote(lote, &cursor);
+            } else if (strcmp(comando, "turno") == 0) {
+                executarTurnoLote(lote);
+            } else if (strcmp(comando, "desfazer") == 0 || strcmp(comando, "refazer") == 0) {
+                // "desfazer [N]" / "refazer [N]": volta ou avança N ataques (padrão 1)
+                int desfazer = comando[0] == 'd';
+                char* token = proximoToken(&cursor);
+                int alteracoes = 0;
+                valor = 1;
+                if (token != NULL && (!converterInteiro(token, &valor) || valor < 1)) {
+                    falharLote(lote, "esperado 'desfazer [N]' ou 'refazer [N]'");
+                    return;
+                }
+                for (long long k = 0; k < valor; k++) {
+                    int feitas = desfazer ? desfazerJogada(&jogo->mapa) : refazerJogada(&jogo->mapa);
+                    if (feitas == 0) break;
+                    alteracoes += feitas;
+                }
+                if (lote->exibirEventos) {
+                    fprintf(lote->saida, "%c %d\n", desfazer ? 'U' : 'F', alteracoes);
+                }
+            } else if (strcmp(comando, "fronteiras") == 0 && jogo->mapa.vizinhos == NULL && jogo->ataques == 0) {
+                // "fronteiras K" seguido de K pares; antes do primeiro ataque
+                if (!converterInteiro(proximoToken(&cursor), &valor) || valor < 1 || valor > 1000000000) {
+                    falharLote(lote, "esperado 'fronteiras K' com K >= 1");
+                    return;
+                }
+                free(lote->pares);
+                lote->pares = (int*)malloc((size_t)valor * 2 * sizeof(int));
+                if (lote->pares == NULL) {
+                    falharLote(lote, "sem memoria para fronteiras");
+                    return;
+                }
+                lote->totalPares = 0;
+                lote->pendentes = (int)valor;
+                lote->fase = LOTE_FRONTEIRAS;
+            } else if (strcmp(comando, "missao") == 0) {
+                // "missao <jogador> <k>": fixa a missão k (1 a 7) para um jogador
+                long long jogador, indice;
+                if (!converterInteiro(proximoToken(&cursor), &jogador) || 
+                    !converterInteiro(proximoToken(&cursor), &indice) || 
+                    jogador < 1 || jogador > jogo->numJogadores || indice < 1 || indice > TOTAL_MISSOES) {
+                    falharLote(lote, "esperado 'missao <jogador> <k>'");
+                    return;
+                }
+                Missao* missao = &jogo->jogadores[jogador - 1].missao;
+                const DefinicaoMissao* definicao = &missoesPredefinidas[indice - 1];
+                missao->tipo = definicao->tipo;
+                missao->parametro = definicao->parametro;
+                missao->definicao = (int)indice - 1;
+                missao->corAlvo = definicao->tipo == MISSAO_ELIMINAR_COR 
+                                  ? buscarCor(&jogo->mapa.cores, definicao->alvo) : -1;
+                resolverAlvosMissoes(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+            } else {
+                falharLote(lote, "comando desconhecido");
+            }
+            return;
+        
+        case LOTE_AGUARDANDO:
+            falharLote(lote, "esperado 'jogadores N'");
+            return;
+        
+        case LOTE_DESCARTANDO:
+            return;
+    }
+}
+
+// Função para processar uma linha de um roteiro em lote
+void processarLinhaLote(ProcessadorLote* lote, char* linha) {
+    INICIAR_MEDICAO(LATENCIA_COMANDO_LOTE);
+    CONTAR_METRICA(CONTADOR_COMANDOS_LOTE, 1);
+    interpretarLinhaLote(lote, linha);
+    ENCERRAR_MEDICAO(LATENCIA_COMANDO_LOTE);
+}
+
+// Função para ler toda a entrada de uma vez em um único buffer terminado em \0
+char* lerEntradaCompleta(FILE* arquivo, size_t* tamanho) {
+    size_t capacidade = 1 << 16, usado = 0;
+    char* buffer = (char*)malloc(capacidade + 1);
+    
+    while (buffer != NULL) {
+        size_t lidos = fread(buffer + usado, 1, capacidade - usado, arquivo);
+        usado += lidos;
+        if (lidos == 0) break;
+        if (usado == capacidade) {
+            capacidade *= 2;
+            char* maior = (char*)realloc(buffer, capacidade + 1);
+            if (maior == NULL) free(buffer);
+            buffer = maior;
+        }
+    }
+    if (buffer != NULL) {
+        buffer[usado] = '\0';
+        *tamanho = usado;
+    }
+    return buffer;
+}
+
+// Modo de linha de comando: war --lote [arquivo|-] [--eventos] [--semente N]
+// Formato do roteiro (uma partida por bloco, '#' inicia comentário):
+//   semente 42            (opcional, vale para a próxima partida)
+//   jogadores 2
+//   Ana Azul
+//   Bia Verde
+//   territorios 3
+//   Norte Azul 5
+//   Sul Verde 3
+//   Capital Verde 2       (nomes de território não podem se repetir)
+//   fronteiras 2          (opcional: sem fronteiras, todos podem atacar todos)
+//   1 2
+//   Sul Capital
+//   missao 1 7            (opcional: fixa a missão 7 da tabela para o jogador 1)
+//   ataque 1 2            (índices de 1 a N ou nomes; "ataque Norte Sul" é o mesmo ataque)
+//   blitz 1 2 50 classico (opcional: repete o ataque até conquistar, ficar com 1 tropa
+//                          ou fazer 50 rolagens; "classico" usa 3 dados contra 2)
+//   ordem 1 1 2           (opcional: guarda o ataque 1 -> 2 do jogador 1 para o próximo turno)
+//   ordem 2 3 1
+//   turno                 (resolve as ordens guardadas de uma vez; veja resolverTurnoSimultaneo)
+//   desfazer 1            (opcional: volta N ataques; "refazer N" os reaplica)
+//   fim                   (opcional)
+int executarModoLote(int argc, char* argv[]) {
+    const char* caminho = "-";
+    ProcessadorLote lote;
+    
+    memset(&lote, 0, sizeof(lote));
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--eventos") == 0) {
+            lote.exibirEventos = 1;
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            lote.sementeBase = strtoull(argv[++i], NULL, 10);
+        } else {
+            caminho = argv[i];
+        }
+    }
+    
+    FILE* arquivo = strcmp(caminho, "-") == 0 ? stdin : fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir '%s'!\n", caminho);
+        return 1;
+    }
+    size_t tamanho;
+    char* entrada = lerEntradaCompleta(arquivo, &tamanho);
+    if (arquivo != stdin) fclose(arquivo);
+    if (entrada == NULL) {
+        fprintf(stderr, "Erro: Não foi possível ler a entrada!\n");
+        return 1;
+    }
+    
+    // Saída totalmente bufferizada: só resultados e eventos são escritos
+    static char bufferSaida[1 << 16];
+    setvbuf(stdout, bufferSaida, _IOFBF, sizeof(bufferSaida));
+    lote.saida = stdout;
+    if (!criarArena(&lote.arena, TAMANHO_ARENA_PADRAO)) {
+        fprintf(stderr, "Erro: Não foi possível reservar a memória das partidas!\n");
+        return 1;
+    }
+    lote.jogo = criarJogoNaArena(&lote.arena, 0);
+    
+    char* linha = entrada;
+    char* fimEntrada = entrada + tamanho;
+    while (linha < fimEntrada) {
+        char* quebra = (char*)memchr(linha, '\n', fimEntrada - linha);
+        if (quebra == NULL) quebra = fimEntrada;
+        *quebra = '\0';
+        processarLinhaLote(&lote, linha);
+        linha = quebra + 1;
+    }
+    publicarResultadoLote(&lote);
+    
+    encerrarJogo(lote.jogo);
+    destruirArena(&lote.arena);
+    free(lote.diario.registros);
+    free(lote.pares);
+    free(lote.ordens);
+    free(entrada);
+    fflush(stdout);
+    return 0;
+}
+
+// Modo servidor: muitas partidas simultâneas em um único processo, atendidas
+// por um laço epoll em um socket Unix. Cada conexão é uma sessão com o seu
+// próprio processador de lote (e a sua arena); o protocolo é o do roteiro em
+// lote, com eventos sempre ligados, mais os comandos de consulta do menu.
+// Toda linha recebida é respondida com zero ou mais linhas e uma linha ".".
+#define TAMANHO_ARENA_SESSAO ((size_t)64 << 20)
+#define MAX_LINHA_SESSAO (1 << 16)          // Uma linha maior encerra a sessão
+#define MAX_SAIDA_PENDENTE (1 << 22)        // Acima disso a sessão só volta a ser lida depois de esvaziar
+#define EVENTOS_POR_ESPERA 256
+
+typedef struct SessaoServidor {
+    int descritor;
+    ProcessadorLote lote;
+    FILE* saida;                    // Acrescenta em 'pendente' (fopencookie)
+    char* entrada;                  // Bytes recebidos que ainda não formam uma linha
+    size_t usadoEntrada, capacidadeEntrada;
+    char* pendente;                 // Respostas ainda não enviadas
+    size_t usadoPendente, enviadoPendente, capacidadePendente;
+    int encerrar;                   // "sair": fecha depois de enviar tudo
+    uint32_t eventos;               // Interesse registrado no epoll
+    struct SessaoServidor* anterior;
+    struct SessaoServidor* proxima;
+} SessaoServidor;
+
+static volatile sig_atomic_t servidorAtivo = 1;
+
+// Função para pedir o encerramento do servidor (SIGINT/SIGTERM)
+static void pararServidor(int sinal) {
+    (void)sinal;
+    servidorAtivo = 0;
+}
+
+// Função chamada pelo FILE* da sessão: acrescenta o texto às respostas pendentes
+static ssize_t escreverSaidaSessao(void* cookie, const char* dados, size_t tamanho) {
+    SessaoServidor* sessao = (SessaoServidor*)cookie;
+    if (sessao->usadoPendente + tamanho > sessao->capacidadePendente) {
+        size_t capacidade = sessao->capacidadePendente > 0 ? sessao->capacidadePendente : 4096;
+        while (capacidade < sessao->usadoPendente + tamanho) capacidade *= 2;
+        char* maior = (char*)realloc(sessao->pendente, capacidade);
+        if (maior == NULL) return -1;
+        sessao->pendente = maior;
+        sessao->capacidadePendente = capacidade;
+    }
+    memcpy(sessao->pendente + sessao->usadoPendente, dados, tamanho);
+    sessao->usadoPendente += tamanho;
+    return (ssize_t)tamanho;
+}
+
+// Função para abrir uma sessão para uma conexão aceita (NULL sem memória)
+static SessaoServidor* abrirSessao(int descritor, uint64_t semente) {
+    SessaoServidor* sessao = (SessaoServidor*)calloc(1, sizeof(SessaoServidor));
+    if (sessao == NULL) return NULL;
+    if (!criarArena(&sessao->lote.arena, TAMANHO_ARENA_SESSAO)) {
+        free(sessao);
+        return NULL;
+    }
+    cookie_io_functions_t funcoes = {.write = escreverSaidaSessao};
+    sessao->saida = fopencookie(sessao, "w", funcoes);
+    if (sessao->saida == NULL) {
+        destruirArena(&sessao->lote.arena);
+        free(sessao);
+        return NULL;
+    }
+    sessao->descritor = descritor;
+    sessao->lote.saida = sessao->saida;
+    sessao->lote.exibirEventos = 1;
+    sessao->lote.sementeBase = semente;
+    sessao->lote.jogo = criarJogoNaArena(&sessao->lote.arena, 0);
+    return sessao;
+}
+
+// Função para fechar uma sessão e liberar tudo o que ela usa
+static void fecharSessao(SessaoServidor* sessao) {
+    close(sessao->descritor); // Também a remove do epoll
+    fclose(sessao->saida);
+    encerrarJogo(sessao->lote.jogo);
+    destruirArena(&sessao->lote.arena);
+    free(sessao->lote.diario.registros);
+    free(sessao->lote.pares);
+    free(sessao->lote.ordens);
+    free(sessao->entrada);
+    free(sessao->pendente);
+    free(sessao);
+}
+
+// Função para saber se o primeiro token da linha é 'nome' (sem alterar a linha)
+static int linhaComecaCom(const char* linha, const char* nome) {
+    size_t tamanho = strlen(nome);
+    while (*linha == ' ' || *linha == '\t') linha++;
+    return strncmp(linha, nome, tamanho) == 0 && 
+           (linha[tamanho] == '\0' || linha[tamanho] == ' ' || linha[tamanho] == '\t' || linha[tamanho] == '\r');
+}
+
+// Função para responder aos comandos de consulta, equivalentes às opções do menu:
+// "mapa [pagina]", "missoes", "vencedor" e "sair". Retorna 0 se a linha não é
+// uma consulta, e ela segue para o processador de lote.
+static int responderConsultaSessao(SessaoServidor* sessao, char* linha, BufferSaida* buffer) {
+    Jogo* jogo = sessao->lote.jogo;
+    FILE* saida = sessao->saida;
+    char* cursor = linha;
+    
+    if (linhaComecaCom(linha, "sair")) {
+        sessao->encerrar = 1;
+        return 1;
+    }
+    if (linhaComecaCom(linha, "mapa")) {
+        long long pagina = 0;
+        char* token;
+        proximoToken(&cursor);
+        token = proximoToken(&cursor);
+        if (token != NULL && (!converterInteiro(token, &pagina) || pagina < 0)) {
+            fprintf(saida, "erro: esperado 'mapa [pagina]'\n");
+        } else {
+            OpcoesExibicao opcoes = {EXIBICAO_TABELA, pagina > INT32_MAX ? INT32_MAX : (int)pagina, 
+                                     TERRITORIOS_POR_PAGINA, -1, 0};
+            buffer->arquivo = saida;
+            renderizarMapa(&jogo->mapa, &opcoes, buffer);
+        }
+        return 1;
+    }
+    if (linhaComecaCom(linha, "missoes")) {
+        for (int i = 0; i < jogo->numJogadores; i++) {
+            char texto[128];
+            descreverMissao(&jogo->jogadores[i].missao, texto, sizeof(texto));
+            fprintf(saida, "missao %d %s %s %d %s\n", i + 1, jogo->jogadores[i].nome, 
+                    nomeCor(&jogo->mapa.cores, jogo->jogadores[i].cor), 
+                    jogo->jogadores[i].missao.definicao + 1, texto);
+        }
+        return 1;
+    }
+    if (linhaComecaCom(linha, "vencedor")) {
+        // Como depois de um ataque: um vencedor publica o resultado e encerra a partida
+        if (jogo->vencedor < 0 && sessao->lote.fase == LOTE_JOGANDO) {
+            jogo->vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+            if (jogo->vencedor >= 0) {
+                publicarResultadoLote(&sessao->lote);
+                sessao->lote.fase = LOTE_DESCARTANDO;
+            }
+        }
+        if (jogo->vencedor >= 0) {
+            fprintf(saida, "vencedor %d %s %s\n", jogo->vencedor + 1, jogo->jogadores[jogo->vencedor].nome, 
+                    nomeCor(&jogo->mapa.cores, jogo->jogadores[jogo->vencedor].cor));
+        } else {
+            fprintf(saida, "sem_vencedor\n");
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Função para responder as linhas completas já recebidas. Para quando a fila
+// de respostas passa de MAX_SAIDA_PENDENTE; o resto espera o envio esvaziar.
+// Retorna 0 se a sessão deve ser fechada.
+static int processarLinhasSessao(SessaoServidor* sessao, BufferSaida* buffer) {
+    char* linha = sessao->entrada;
+    char* fimEntrada = sessao->entrada + sessao->usadoEntrada;
+    char* quebra;
+    while (!sessao->encerrar && sessao->usadoPendente - sessao->enviadoPendente <= MAX_SAIDA_PENDENTE && 
+           (quebra = (char*)memchr(linha, '\n', fimEntrada - linha)) != NULL) {
+        *quebra = '\0';
+        if (!responderConsultaSessao(sessao, linha, buffer)) {
+            processarLinhaLote(&sessao->lote, linha);
+        }
+        fputs(".\n", sessao->saida);
+        if (fflush(sessao->saida) != 0) return 0;
+        linha = quebra + 1;
+    }
+    sessao->usadoEntrada = sessao->encerrar ? 0 : (size_t)(fimEntrada - linha);
+    memmove(sessao->entrada, linha, sessao->usadoEntrada);
+    return 1;
+}
+
+// Função para saber se há uma linha completa esperando resposta
+static int temLinhaSessao(const SessaoServidor* sessao) {
+    return !sessao->encerrar && memchr(sessao->entrada, '\n', sessao->usadoEntrada) != NULL;
+}
+
+// Função para ler o que chegou na conexão. Retorna 0 se a sessão deve ser fechada.
+static int lerSessao(SessaoServidor* sessao) {
+    if (sessao->usadoEntrada == sessao->capacidadeEntrada) {
+        if (sessao->capacidadeEntrada >= MAX_LINHA_SESSAO) return 0;
+        size_t capacidade = sessao->capacidadeEntrada > 0 ? sessao->capacidadeEntrada * 2 : 4096;
+        char* maior = (char*)realloc(sessao->entrada, capacidade + 1);
+        if (maior == NULL) return 0;
+        sessao->entrada = maior;
+        sessao->capacidadeEntrada = capacidade;
+    }
+    ssize_t lidos = read(sessao->descritor, sessao->entrada + sessao->usadoEntrada, 
+                         sessao->capacidadeEntrada - sessao->usadoEntrada);
+    if (lidos == 0) return 0;
+    if (lidos < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    sessao->usadoEntrada += (size_t)lidos;
+    return 1;
+}
+
+// Função para enviar as respostas pendentes sem bloquear. Retorna 0 se a conexão caiu.
+static int enviarSessao(SessaoServidor* sessao) {
+    while (sessao->enviadoPendente < sessao->usadoPendente) {
+        ssize_t enviados = send(sessao->descritor, sessao->pendente + sessao->enviadoPendente, 
+                                sessao->usadoPendente - sessao->enviadoPendente, MSG_NOSIGNAL);
+        if (enviados > 0) {
+            sessao->enviadoPendente += (size_t)enviados;
+        } else if (enviados < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return enviados < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+    sessao->usadoPendente = sessao->enviadoPendente = 0;
+    if (sessao->capacidadePendente > MAX_SAIDA_PENDENTE) {
+        // Uma resposta grande (mapa inteiro) não prende a memória na sessão ociosa
+        free(sessao->pendente);
+        sessao->pendente = NULL;
+        sessao->capacidadePendente = 0;
+    }
+    return 1;
+}
+
+// Função para ajustar o interesse da sessão no epoll: lê enquanto a fila de
+// respostas é pequena e espera EPOLLOUT enquanto há algo para enviar
+static void atualizarInteresseSessao(int epoll, SessaoServidor* sessao) {
+    size_t restante = sessao->usadoPendente - sessao->enviadoPendente;
+    uint32_t eventos = 0;
+    if (!sessao->encerrar && restante <= MAX_SAIDA_PENDENTE && 
+        sessao->usadoEntrada < MAX_LINHA_SESSAO) eventos |= EPOLLIN;
+    if (restante > 0) eventos |= EPOLLOUT;
+    if (eventos != sessao->eventos) {
+        struct epoll_event evento = {.events = eventos, .data.ptr = sessao};
+        epoll_ctl(epoll, EPOLL_CTL_MOD, sessao->descritor, &evento);
+        sessao->eventos = eventos;
+    }
+}
+
+// Modo de linha de comando: war --servidor <caminho> [--semente N] [--max-sessoes N]
+// Cada conexão ao socket Unix em <caminho> é uma sessão com as mesmas linhas
+// do modo em lote (jogadores, territorios, fronteiras, missao, ataque,
+// desfazer, refazer, semente, fim), sempre com eventos, e ainda:
+//   mapa [pagina]         (tabela do mapa; sem página, o mapa inteiro)
+//   missoes               (uma linha "missao <jogador> <nome> <cor> <k> <texto>")
+//   vencedor              ("vencedor <jogador> <nome> <cor>" ou "sem_vencedor")
+//   sair                  (fecha a conexão depois das respostas)
+// Toda linha recebida é respondida com zero ou mais linhas e uma linha ".".
+int executarModoServidor(int argc, char* argv[]) {
+    const char* caminho = NULL;
+    uint64_t semente = 0;
+    int maxSessoes = 10000, totalSessoes = 0, aceitando = 1;
+    long long atendidas = 0;
+    SessaoServidor* sessoes = NULL;
+    
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-sessoes") == 0 && i + 1 < argc) {
+            maxSessoes = atoi(argv[++i]);
+        } else {
+            caminho = argv[i];
+        }
+    }
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (caminho == NULL || strlen(caminho) >= sizeof(endereco.sun_path) || maxSessoes < 1) {
+        fprintf(stderr, "Uso: %s --servidor <caminho> [--semente N] [--max-sessoes N>=1]\n", argv[0]);
+        return 1;
+    }
+    memcpy(endereco.sun_path, caminho, strlen(caminho) + 1);
+    
+    // Um socket antigo no mesmo caminho (de uma execução anterior) é substituído;
+    // qualquer outro tipo de arquivo é preservado e o bind falha
+    struct stat info;
+    if (stat(caminho, &info) == 0 && S_ISSOCK(info.st_mode)) unlink(caminho);
+    
+    // Cada sessão usa um descritor: sobe o limite flexível até o rígido
+    struct rlimit limite;
+    if (getrlimit(RLIMIT_NOFILE, &limite) == 0 && limite.rlim_cur < limite.rlim_max) {
+        limite.rlim_cur = limite.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limite);
+    }
+    
+    int ouvinte = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (ouvinte < 0 || bind(ouvinte, (struct sockaddr*)&endereco, sizeof(endereco)) != 0 || 
+        listen(ouvinte, SOMAXCONN) != 0) {
+        fprintf(stderr, "Erro: Não foi possível escutar em '%s'!\n", caminho);
+        if (ouvinte >= 0) close(ouvinte);
+        return 1;
+    }
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event eventoOuvinte = {.events = EPOLLIN, .data.ptr = NULL};
+    if (epoll < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, ouvinte, &eventoOuvinte) != 0) {
+        fprintf(stderr, "Erro: Não foi possível criar o epoll!\n");
+        close(ouvinte);
+        unlink(caminho);
+        return 1;
+    }
+    
+    // Sem SA_RESTART: o sinal interrompe o epoll_wait e o laço termina
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = pararServidor;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    
+    printf("Servidor aguardando conexões em '%s' (até %d sessões).\n", caminho, maxSessoes);
+    fflush(stdout);
+    
+    static BufferSaida bufferSessoes; // Renderização do mapa, compartilhada: o laço tem uma só thread
+    struct epoll_event eventos[EVENTOS_POR_ESPERA];
+    while (servidorAtivo) {
+        int prontos = epoll_wait(epoll, eventos, EVENTOS_POR_ESPERA, -1);
+        if (prontos < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Erro: epoll_wait falhou!\n");
+            break;
+        }
+        
+        for (int e = 0; e < prontos; e++) {
+            SessaoServidor* sessao = (SessaoServidor*)eventos[e].data.ptr;
+            
+            if (sessao == NULL) {
+                // Novas conexões; sem vaga (ou sem descritores), o ouvinte sai do
+                // epoll e as conexões esperam na fila do listen até uma sessão fechar
+                int semDescritores = 0;
+                while (totalSessoes < maxSessoes) {
+                    int descritor = accept4(ouvinte, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (descritor < 0) {
+                        if (errno == EINTR || errno == ECONNABORTED) continue;
+                        if (errno == EMFILE || errno == ENFILE) semDescritores = 1;
+                        break;
+                    }
+                    SessaoServidor* nova = abrirSessao(descritor, semente);
+                    struct epoll_event evento = {.events = EPOLLIN, .data.ptr = nova};
+                    if (nova == NULL || epoll_ctl(epoll, EPOLL_CTL_ADD, descritor, &evento) != 0) {
+                        if (nova != NULL) fecharSessao(nova); else close(descritor);
+                        continue;
+                    }
+                    nova->eventos = EPOLLIN;
+                    nova->proxima = sessoes;
+                    if (sessoes != NULL) sessoes->anterior = nova;
+                    sessoes = nova;
+                    totalSessoes++;
+                    atendidas++;
+                }
+                if (totalSessoes >= maxSessoes || semDescritores) {
+                    epoll_ctl(epoll, EPOLL_CTL_DEL, ouvinte, NULL);
+                    aceitando = 0;
+                }
+                continue;
+            }
+            
+            int manter = 1;
+            if (eventos[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) manter = lerSessao(sessao);
+            // Responde e envia enquanto houver linhas e a fila de respostas não estiver cheia
+            while (manter) {
+                manter = processarLinhasSessao(sessao, &bufferSessoes) && enviarSessao(sessao);
+                if (!temLinhaSessao(sessao) || 
+                    sessao->usadoPendente - sessao->enviadoPendente > MAX_SAIDA_PENDENTE) break;
+            }
+            if (manter && sessao->encerrar && sessao->usadoPendente == 0) manter = 0;
+            if (manter && sessao->usadoEntrada >= MAX_LINHA_SESSAO && !temLinhaSessao(sessao)) manter = 0;
+            
+            if (manter) {
+                atualizarInteresseSessao(epoll, sessao);
+                continue;
+            }
+            if (sessao->anterior != NULL) sessao->anterior->proxima = sessao->proxima;
+            else sessoes = sessao->proxima;
+            if (sessao->proxima != NULL) sessao->proxima->anterior = sessao->anterior;
+            fecharSessao(sessao);
+            totalSessoes--;
+            if (!aceitando) {
+                epoll_ctl(epoll, EPOLL_CTL_ADD, ouvinte, &eventoOuvinte);
+                aceitando = 1;
+            }
+        }
+    }
+    
+    while (sessoes != NULL) {
+        SessaoServidor* proxima = sessoes->proxima;
+        fecharSessao(sessoes);
+        sessoes = proxima;
+    }
+    close(epoll);
+    close(ouvinte);
+    unlink(caminho);
+    printf("Servidor encerrado (%lld sessões atendidas).\n", atendidas);
+    return 0;
+}
+
+// Função para cadastrar as fronteiras entre territórios pelo terminal
+void cadastrarFronteiras(Mapa* mapa) {
+    int totalFronteiras;
+    
+    printf("\n=== FASE DE CADASTRO DAS FRONTEIRAS ===\n");
+    do {
+        printf("Quantas fronteiras deseja cadastrar? (0 = todos podem atacar todos): ");
+        scanf("%d", &totalFronteiras);
+    } while (totalFronteiras < 0);
+    if (totalFronteiras == 0) return;
+    
+    int* pares = (int*)malloc((size_t)totalFronteiras * 2 * sizeof(int));
+    if (pares == NULL) {
+        printf("Erro: Não foi possível alocar memória para as fronteiras!\n");
+        exit(1);
+    }
+    for (int k = 0; k < totalFronteiras; k++) {
+        int a, b;
+        do {
+            printf("Fronteira %d - territórios (1 a %d) separados por espaço: ", k + 1, mapa->quantidade);
+            scanf("%d %d", &a, &b);
+        } while (a < 1 || b < 1 || a > mapa->quantidade || b > mapa->quantidade);
+        pares[2 * k] = a - 1;
+        pares[2 * k + 1] = b - 1;
+    }
+    
+    if (!construirGrafo(mapa, pares, totalFronteiras)) {
+        printf("Erro: Não foi possível alocar memória para as fronteiras!\n");
+        exit(1);
+    }
+    free(pares);
+    printf("%d fronteiras cadastradas.\n", totalFronteiras);
+}
+
+// Função para cadastrar jogadores e territórios de uma nova partida pelo terminal
+void cadastrarPartida(Jogo* jogo) {
+    int quantidadeTeritorios, numJogadores;
+    
+    // Solicitar número de jogadores
+    do {
+        printf("Quantos jogadores irão participar? (2-4): ");
+        scanf("%d", &numJogadores);
+        if (numJogadores < 2 || numJogadores > 4) {
+            printf("Erro: O jogo deve ter entre 2 e 4 jogadores!\n");
+        }
+    } while (numJogadores < 2 || numJogadores > 4);
+    
+    // Alocar memória para jogadores
+    jogo->jogadores = alocarJogadores(jogo->mapa.arena, numJogadores);
+    jogo->capacidadeJogadores = numJogadores;
+    
+    // Cadastrar jogadores
+    printf("\n=== FASE DE CADASTRO DOS JOGADORES ===\n");
+    for (int i = 0; i < numJogadores; i++) {
+        cadastrarJogador(&jogo->jogadores[i], i, &jogo->mapa.cores, &jogo->gerador);
+        jogo->numJogadores++;
+    }
+    
+    // Solicitar quantidade de territórios
+    do {
+        printf("\nQuantos territórios deseja cadastrar? (mínimo %d): ", numJogadores);
+        scanf("%d", &quantidadeTeritorios);
+        if (quantidadeTeritorios < numJogadores) {
+            printf("Erro: Deve haver pelo menos 1 território por jogador!\n");
+        }
+    } while (quantidadeTeritorios < numJogadores);
+    
+    // Alocar memória dinamicamente para territórios
+    alocarTeritorios(&jogo->mapa, quantidadeTeritorios);
+    
+    printf("\n=== FASE DE CADASTRO DOS TERRITÓRIOS ===\n");
+    printf("Você irá cadastrar %d territórios.\n", quantidadeTeritorios);
+    
+    // Cadastrar territórios
+    for (int i = 0; i < quantidadeTeritorios; i++) {
+        cadastrarTerritorio(&jogo->mapa, i);
+    }
+    cadastrarFronteiras(&jogo->mapa);
+    resolverAlvosMissoes(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+}
+
+// Paleta usada nas partidas sintéticas (cores extras recebem nomes numerados)
+const char* paletaCores[] = {
+    "Azul", "Verde", "Vermelho", "Amarelo", "Preto", "Branco", "Roxo", "Laranja"
+};
+
+#define TOTAL_PALETA 8
+
+// Função para montar uma partida sintética, sem I/O: 'numJogadores' jogadores,
+// 'numCores' cores (as que sobram são exércitos neutros), territórios "T1".."Tn"
+// (o último se chama "Capital", alvo de uma das missões) com cor e tropas
+// sorteadas e, se 'comFronteiras', um grafo em grade.
+// 'jogo' deve vir vazio (iniciarJogo ou criarJogoNaArena); os sorteios usam o gerador dele.
+// Retorna 1 em caso de sucesso e 0 se os parâmetros forem inválidos ou faltar memória.
+int gerarJogoSintetico(Jogo* jogo, int numTerritorios, int numJogadores, int numCores, 
+                       int comFronteiras) {
+    char nome[32], cor[10];
+    
+    if (numCores < numJogadores) numCores = numJogadores;
+    if (numJogadores < 1 || numCores >= MAX_CORES || numTerritorios < numJogadores) return 0;
+    
+    for (int j = 0; j < numJogadores; j++) {
+        snprintf(nome, sizeof(nome), "J%d", j + 1);
+        if (j < TOTAL_PALETA) snprintf(cor, sizeof(cor), "%s", paletaCores[j]);
+        else snprintf(cor, sizeof(cor), "Cor%d", (j + 1) % 100);
+        if (adicionarJogador(jogo, nome, cor) == NULL) return 0;
+    }
+    if (!reservarTerritorios(&jogo->mapa, numTerritorios)) return 0;
+    
+    for (int t = 0; t < numTerritorios; t++) {
+        Territorio territorio;
+        // Cada jogador recebe ao menos um território; o resto é sorteado
+        int c = t < numJogadores ? t : sortearIntervalo(&jogo->gerador, (uint32_t)numCores);
+        if (t == numTerritorios - 1) snprintf(territorio.nome, sizeof(territorio.nome), "Capital");
+        else snprintf(territorio.nome, sizeof(territorio.nome), "T%d", t + 1);
+        if (c < TOTAL_PALETA) snprintf(territorio.cor, sizeof(territorio.cor), "%s", paletaCores[c]);
+        else snprintf(territorio.cor, sizeof(territorio.cor), "Cor%d", (c + 1) % 100);
+        territorio.tropas = 1 + sortearIntervalo(&jogo->gerador, 10);
+        adicionarTerritorio(&jogo->mapa, &territorio);
+    }
+    
+    if (comFronteiras) {
+        // Grade com 'largura' colunas: cada território faz fronteira à direita e abaixo
+        int largura = 1;
+        while ((long long)largura * largura < numTerritorios) largura++;
+        int* pares = (int*)malloc((size_t)numTerritorios * 4 * sizeof(int));
+        int64_t total = 0;
+        if (pares == NULL) return 0;
+        for (int t = 0; t < numTerritorios; t++) {
+            if ((t + 1) % largura != 0 && t + 1 < numTerritorios) {
+                pares[2 * total] = t;
+                pares[2 * total++ + 1] = t + 1;
+            }
+            if (t + largura < numTerritorios) {
+                pares[2 * total] = t;
+                pares[2 * total++ + 1] = t + largura;
+            }
+        }
+        int ok = construirGrafo(&jogo->mapa, pares, total);
+        free(pares);
+        if (!ok) return 0;
+    }
+    
+    resolverAlvosMissoes(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+    return 1;
+}
+
+// Contexto de um caso de benchmark (o ponteiro é repassado à função medida)
+typedef struct {
+    Jogo* jogo;
+    Missao missao;
+    int* pares;             // Pares atacante/defensor pré-sorteados
+    uint8_t* dados;         // Dados pré-sorteados
+    int totalPares;
+    Arena arenaClone;       // Destino do benchmark de clonagem
+    DiarioJogadas diario;   // Diário do benchmark de desfazer
+    int versaoVarredura;    // Versão medida no benchmark de varredura
+    int falhou;             // O caso atual não pôde ser executado (medirBenchmark o abandona)
+    long long acumulador;   // Impede que o compilador descarte o trabalho medido
+} ContextoBenchmark;
+
+typedef void (*FuncaoBenchmark)(ContextoBenchmark*, long long);
+
+// Benchmark: validar e resolver ataques entre pares sorteados
+static void benchmarkBatalha(ContextoBenchmark* contexto, long long iteracoes) {
+    Mapa* mapa = &contexto->jogo->mapa;
+    for (long long i = 0; i < iteracoes; i++) {
+        int k = (int)(i % contexto->totalPares);
+        int atacante = contexto->pares[2 * k], defensor = contexto->pares[2 * k + 1];
+        if (analisarAtaque(mapa, atacante, defensor) == ATAQUE_VALIDO) {
+            ResultadoBatalha resultado = resolverAtaque(mapa, atacante, defensor, 
+                                                        contexto->dados[2 * k], contexto->dados[2 * k + 1]);
+            contexto->acumulador += resultado.conquistou;
+        } else if (mapa->tropas[atacante] < 2) {
+            definirTropas(mapa, atacante, 10); // Reforço para manter ataques possíveis
+        }
+    }
+}
+
+// Benchmark: verificar uma missão do jogador 1
+static void benchmarkMissao(ContextoBenchmark* contexto, long long iteracoes) {
+    const Jogo* jogo = contexto->jogo;
+    for (long long i = 0; i < iteracoes; i++) {
+        contexto->acumulador += verificarMissao(&contexto->missao, &jogo->mapa, jogo->jogadores[0].cor);
+    }
+}
+
+// Benchmark: procurar um vencedor entre todos os jogadores
+static void benchmarkVencedor(ContextoBenchmark* contexto, long long iteracoes) {
+    Jogo* jogo = contexto->jogo;
+    for (long long i = 0; i < iteracoes; i++) {
+        int vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+        if (vencedor >= 0) jogo->jogadores[vencedor].venceu = 0;
+        contexto->acumulador += vencedor;
+    }
+}
+
+// Benchmark: procurar um vencedor recalculando tudo por uma varredura das colunas
+static void benchmarkVencedorVarredura(ContextoBenchmark* contexto, long long iteracoes) {
+    Jogo* jogo = contexto->jogo;
+    for (long long i = 0; i < iteracoes; i++) {
+        int vencedor = encontrarVencedorVarredura(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+        if (vencedor >= 0) jogo->jogadores[vencedor].venceu = 0;
+        contexto->acumulador += vencedor;
+    }
+}
+
+// Benchmark: uma varredura das colunas com todas as cores do mapa, em uma versão fixa
+static void benchmarkVarredura(ContextoBenchmark* contexto, long long iteracoes) {
+    const Mapa* mapa = &contexto->jogo->mapa;
+    uint8_t cores[MAX_CORES];
+    ResumoCor resumos[MAX_CORES];
+    for (int c = 0; c < mapa->cores.total; c++) cores[c] = (uint8_t)c;
+    for (long long i = 0; i < iteracoes; i++) {
+        versoesVarredura[contexto->versaoVarredura].varrer(mapa, cores, mapa->cores.total, resumos);
+        contexto->acumulador += resumos[0].territorios;
+    }
+}
+
+// Benchmark: resolver um ataque e desfazê-lo pelo diário (o mapa volta ao estado anterior)
+static void benchmarkDesfazer(ContextoBenchmark* contexto, long long iteracoes) {
+    Mapa* mapa = &contexto->jogo->mapa;
+    mapa->diario = &contexto->diario;
+    for (long long i = 0; i < iteracoes; i++) {
+        int k = (int)(i % contexto->totalPares);
+        int atacante = contexto->pares[2 * k], defensor = contexto->pares[2 * k + 1];
+        if (analisarAtaque(mapa, atacante, defensor) != ATAQUE_VALIDO) continue;
+        ResultadoBatalha resultado = resolverAtaque(mapa, atacante, defensor, 
+                                                    contexto->dados[2 * k], contexto->dados[2 * k + 1]);
+        contexto->acumulador += resultado.conquistou + desfazerJogada(mapa);
+    }
+    limparDiario(&contexto->diario);
+    mapa->diario = NULL;
+}
+
+// Benchmark: buscar pelo nome os territórios dos pares sorteados
+static void benchmarkBuscaNome(ContextoBenchmark* contexto, long long iteracoes) {
+    const Mapa* mapa = &contexto->jogo->mapa;
+    for (long long i = 0; i < iteracoes; i++) {
+        int k = (int)(i % (2 * contexto->totalPares));
+        contexto->acumulador += buscarTerritorio(mapa, nomeTerritorio(mapa, contexto->pares[k]));
+    }
+}
+
+// Benchmark: clonar a partida inteira (memcpy da arena e ajuste dos ponteiros)
+static void benchmarkClonagem(ContextoBenchmark* contexto, long long iteracoes) {
+    for (long long i = 0; i < iteracoes; i++) {
+        Jogo* clone = clonarJogo(contexto->jogo, &contexto->arenaClone);
+        if (clone == NULL) {
+            // Partida fora de arena, mapeada de um snapshot ou maior que a arena do clone
+            contexto->falhou = 1;
+            return;
+        }
+        contexto->acumulador += clone->mapa.quantidade;
+    }
+}
+
+// Função para medir um caso: dobra as iterações até passar de ~50 ms e
+// imprime uma linha JSON com ns por operação e vazão
+void medirBenchmark(const char* nome, FuncaoBenchmark funcao, ContextoBenchmark* contexto, 
+                    int numJogadores, int numCores) {
+    long long iteracoes = 1;
+    double duracao = 0;
+    
+    funcao(contexto, 1); // Aquecimento
+    while (!contexto->falhou && iteracoes < (1LL << 40)) {
+        double inicio = tempoAtual();
+        funcao(contexto, iteracoes);
+        duracao = tempoAtual() - inicio;
+        if (duracao >= 0.05) break;
+        iteracoes *= 2;
+    }
+    if (contexto->falhou) {
+        fprintf(stderr, "Erro: o caso '%s' não pôde ser executado e foi abandonado!\n", nome);
+        contexto->falhou = 0;
+        return;
+    }
+    
+    double nsOp = duracao * 1e9 / iteracoes;
+    printf("{\"bench\":\"%s\",\"territorios\":%d,\"jogadores\":%d,\"cores\":%d,"
+           "\"iteracoes\":%lld,\"ns_op\":%.3f,\"ops_s\":%.0f}\n", 
+           nome, contexto->jogo->mapa.quantidade, numJogadores, numCores, 
+           iteracoes, nsOp, nsOp > 0 ? 1e9 / nsOp : 0.0);
+    fflush(stdout);
+}
+
+// Função para liberar o que um tamanho de mapa do benchmark alocou (também
+// quando a preparação parou no meio: os ponteiros e arenas não criados estão zerados)
+static void liberarContextoBenchmark(ContextoBenchmark* contexto, Arena* arena) {
+    free(contexto->pares);
+    free(contexto->dados);
+    free(contexto->diario.registros);
+    destruirArena(arena);
+    destruirArena(&contexto->arenaClone);
+}
+
+// Nomes dos benchmarks de missão, na ordem de TipoMissao
+const char* nomesBenchmarkMissao[TOTAL_TIPOS_MISSAO] = {
+    "missao_sequencia", "missao_eliminar_cor", "missao_controlar", "missao_acumular",
+    "missao_cores_diferentes", "missao_total_tropas", "missao_territorio"
+};
+
+// Modo de linha de comando: war --bench [maxTerritorios] [jogadores] [cores] [--fronteiras]
+// Gera mapas de 10 a maxTerritorios (potências de 10) e imprime uma linha JSON por caso.
+int executarModoBenchmark(int argc, char* argv[]) {
+    int maxTerritorios = 1000000, numJogadores = 4, numCores = 6, comFronteiras = 0;
+    int posicional = 0;
+    
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--fronteiras") == 0) {
+            comFronteiras = 1;
+        } else if (posicional == 0) {
+            maxTerritorios = atoi(argv[i]);
+            posicional++;
+        } else if (posicional == 1) {
+            numJogadores = atoi(argv[i]);
+            posicional++;
+        } else {
+            numCores = atoi(argv[i]);
+        }
+    }
+    if (numJogadores < 1 || numCores < numJogadores || numCores >= MAX_CORES || maxTerritorios < 10) {
+        fprintf(stderr, "Uso: %s --bench [maxTerritorios>=10] [jogadores] [cores<%d] [--fronteiras]\n", 
+                argv[0], MAX_CORES);
+        return 1;
+    }
+    
+    for (long long territorios = 10; territorios <= maxTerritorios; territorios *= 10) {
+        Arena arena;
+        ContextoBenchmark contexto;
+        
+        if (territorios < numJogadores) continue;
+        memset(&arena, 0, sizeof(arena));
+        memset(&contexto, 0, sizeof(contexto));
+        // Partida e clone em arenas, com folga para as colunas, os nomes e o grafo
+        size_t tamanhoArena = (size_t)territorios * 256 + ((size_t)1 << 20);
+        if (!criarArena(&arena, tamanhoArena) || !criarArena(&contexto.arenaClone, tamanhoArena)) {
+            fprintf(stderr, "Erro: Não foi possível reservar memória para %lld territórios!\n", territorios);
+            liberarContextoBenchmark(&contexto, &arena);
+            return 1;
+        }
+        double inicio = tempoAtual();
+        Jogo* jogo = criarJogoNaArena(&arena, 42);
+        if (jogo == NULL || !gerarJogoSintetico(jogo, (int)territorios, numJogadores, numCores, comFronteiras)) {
+            fprintf(stderr, "Erro: Não foi possível gerar o mapa com %lld territórios!\n", territorios);
+            liberarContextoBenchmark(&contexto, &arena);
+            return 1;
+        }
+        printf("{\"bench\":\"gerar_mapa\",\"territorios\":%lld,\"jogadores\":%d,\"cores\":%d,\"ms\":%.3f}\n", 
+               territorios, numJogadores, numCores, (tempoAtual() - inicio) * 1e3);
+        contexto.jogo = jogo;
+        
+        // Pares de ataque e dados sorteados antes da medição
+        contexto.totalPares = 4096;
+        contexto.pares = (int*)malloc(2 * contexto.totalPares * sizeof(int));
+        contexto.dados = (uint8_t*)malloc(2 * contexto.totalPares);
+        if (contexto.pares == NULL || contexto.dados == NULL) {
+            fprintf(stderr, "Erro: Sem memória para o benchmark!\n");
+            liberarContextoBenchmark(&contexto, &arena);
+            return 1;
+        }
+        for (int k = 0; k < contexto.totalPares; k++) {
+            int atacante = sortearIntervalo(&jogo->gerador, (uint32_t)territorios);
+            int defensor = sortearIntervalo(&jogo->gerador, (uint32_t)territorios);
+            if (comFronteiras) {
+                // Com grade, o defensor é um vizinho do atacante
+                int implicitos[2];
+                const int* vizinhos;
+                int grau = listarVizinhos(&jogo->mapa, atacante, &vizinhos, implicitos);
+                if (grau > 0) defensor = vizinhos[sortearIntervalo(&jogo->gerador, (uint32_t)grau)];
+            }
+            contexto.pares[2 * k] = atacante;
+            contexto.pares[2 * k + 1] = defensor;
+        }
+        preencherDados(&jogo->gerador, contexto.dados, 2 * contexto.totalPares);
+        
+        medirBenchmark("batalha", benchmarkBatalha, &contexto, numJogadores, numCores);
+        
+        // Uma missão de cada tipo, com os parâmetros da tabela
+        for (int k = 0; k < TOTAL_MISSOES; k++) {
+            const DefinicaoMissao* definicao = &missoesPredefinidas[k];
+            contexto.missao.tipo = definicao->tipo;
+            contexto.missao.parametro = definicao->parametro;
+            contexto.missao.definicao = k;
+            contexto.missao.corAlvo = definicao->tipo == MISSAO_ELIMINAR_COR 
+                                      ? buscarCor(&jogo->mapa.cores, definicao->alvo) : -1;
+            contexto.missao.territorioAlvo = definicao->tipo == MISSAO_TERRITORIO ? 0 : -1;
+            medirBenchmark(nomesBenchmarkMissao[definicao->tipo], benchmarkMissao, &contexto, 
+                           numJogadores, numCores);
+        }
+        
+        medirBenchmark("vencedor", benchmarkVencedor, &contexto, numJogadores, numCores);
+        medirBenchmark("vencedor_varredura", benchmarkVencedorVarredura, &contexto, numJogadores, numCores);
+        for (int v = 0; v < TOTAL_VERSOES_VARREDURA; v++) {
+            char nome[32];
+            if (!versaoVarreduraSuportada(v)) continue;
+            snprintf(nome, sizeof(nome), "varredura_%s", versoesVarredura[v].nome);
+            contexto.versaoVarredura = v;
+            medirBenchmark(nome, benchmarkVarredura, &contexto, numJogadores, numCores);
+        }
+        medirBenchmark("busca_nome", benchmarkBuscaNome, &contexto, numJogadores, numCores);
+        medirBenchmark("clonar_jogo", benchmarkClonagem, &contexto, numJogadores, numCores);
+        medirBenchmark("ataque_desfazer", benchmarkDesfazer, &contexto, numJogadores, numCores);
+        
+        liberarContextoBenchmark(&contexto, &arena);
+    }
+    return 0;
+}
+
+// Política automática usada nos torneios: onde reforçar e quem atacar
+typedef struct {
+    const char* nome;
+    // Escolhe o território que recebe os reforços do turno
+    int (*escolherReforco)(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador);
+    // Escolhe um ataque válido; retorna 0 se não houver ataque a fazer
+    int (*escolherAtaque)(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador, 
+                          int* atacante, int* defensor);
+} PoliticaAtaque;
+
+// Função auxiliar: 1 se o território tem algum vizinho de outra cor
+static int estaNaFronteira(const Mapa* mapa, int t) {
+    int implicitos[2];
+    const int* vizinhos;
+    int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+    for (int i = 0; i < grau; i++) {
+        if (mapa->cor[vizinhos[i]] != mapa->cor[t]) return 1;
+    }
+    return 0;
+}
+
+// Política aleatória: reforça um território de fronteira qualquer
+static int reforcoAleatorio(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador) {
+    int escolhido = -1, vistos = 0;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor || !estaNaFronteira(mapa, t)) continue;
+        // Amostragem por reservatório: cada candidato com a mesma chance
+        if (sortearIntervalo(gerador, (uint32_t)++vistos) == 0) escolhido = t;
+    }
+    return escolhido;
+}
+
+// Política aleatória: sorteia um entre todos os ataques válidos
+static int ataqueAleatorio(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador, 
+                           int* atacante, int* defensor) {
+    int vistos = 0;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor || mapa->tropas[t] < 2) continue;
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        for (int i = 0; i < grau; i++) {
+            if (mapa->cor[vizinhos[i]] == cor) continue;
+            if (sortearIntervalo(gerador, (uint32_t)++vistos) == 0) {
+                *atacante = t;
+                *defensor = vizinhos[i];
+            }
+        }
+    }
+    return vistos > 0;
+}
+
+// Política gulosa: concentra os reforços no território de fronteira mais forte
+static int reforcoGuloso(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador) {
+    int escolhido = -1;
+    (void)gerador;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor || !estaNaFronteira(mapa, t)) continue;
+        if (escolhido < 0 || mapa->tropas[t] > mapa->tropas[escolhido]) escolhido = t;
+    }
+    return escolhido;
+}
+
+// Política gulosa: ataca com o território de maior chance de conquista
+// (pelas regras atuais, o que tem mais tropas) e, no empate, o defensor mais forte
+static int ataqueGuloso(const Mapa* mapa, uint8_t cor, GeradorAleatorio* gerador, 
+                        int* atacante, int* defensor) {
+    double melhorChance = 0;
+    int encontrou = 0;
+    (void)gerador;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        if (mapa->cor[t] != cor || mapa->tropas[t] < 2) continue;
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        for (int i = 0; i < grau; i++) {
+            int alvo = vizinhos[i];
+            if (mapa->cor[alvo] == cor) continue;
+            double chance = calcularChancesAteConquista(mapa->tropas[t], mapa->tropas[alvo]).conquista;
+            if (!encontrou || chance > melhorChance || 
+                (chance == melhorChance && mapa->tropas[alvo] > mapa->tropas[*defensor])) {
+                melhorChance = chance;
+                *atacante = t;
+                *defensor = alvo;
+                encontrou = 1;
+            }
+        }
+    }
+    return encontrou;
+}
+
+// Políticas disponíveis no modo torneio
+const PoliticaAtaque politicasTorneio[] = {
+    {"aleatoria", reforcoAleatorio, ataqueAleatorio},
+    {"gulosa", reforcoGuloso, ataqueGuloso}
+};
+
+#define TOTAL_POLITICAS 2
+#define MAX_JOGADORES_TORNEIO 8
+#define ATAQUES_POR_TURNO 5
+#define PONTOS_CURVA 32             // Amostras da curva de tropas por partida
+#define PASSO_CURVA 4               // Turnos entre duas amostras da curva
+
+// Relatório do torneio: cada partida soma seus números aqui com operações
+// atômicas, sem travas, então as threads nunca esperam umas pelas outras
+typedef struct {
+    _Atomic long long partidas;
+    _Atomic long long semVencedor;
+    _Atomic long long decididasNoSorteio;                       // Alguma missão já cumprida antes da 1ª jogada
+    _Atomic long long vitoriasNoSorteio;                        // Vencidas por uma dessas missões
+    _Atomic long long turnos;
+    _Atomic long long ataques;
+    _Atomic long long maiorPartida;                             // Mais turnos em uma partida
+    _Atomic long long vitoriasMissao[TOTAL_MISSOES];            // Por posição em missoesPredefinidas
+    _Atomic long long sorteiosMissao[TOTAL_MISSOES];
+    _Atomic long long vitoriasPolitica[TOTAL_POLITICAS];
+    _Atomic long long assentosPolitica[TOTAL_POLITICAS];
+    _Atomic long long vitoriasAssento[MAX_JOGADORES_TORNEIO];
+    _Atomic long long curvaVencedor[PONTOS_CURVA];              // Soma das tropas do vencedor
+    _Atomic long long curvaDemais[PONTOS_CURVA];                // Soma da média dos demais (x1000)
+    _Atomic long long amostrasCurva[PONTOS_CURVA];
+} RelatorioTorneio;
+
+// Configuração comum a todas as partidas de um torneio
+typedef struct {
+    int territorios;
+    int numJogadores;
+    int numCores;
+    int maxTurnos;
+    uint64_t semente;
+    int politicas[MAX_JOGADORES_TORNEIO];   // Política de cada assento
+} ConfiguracaoTorneio;
+
+// Função para jogar uma partida automática do início ao fim, sem I/O, dentro
+// da arena da thread (reiniciada a cada partida, sem nenhum malloc por jogo).
+// A partida 'numero' usa a semente semente + numero, então o resultado não
+// depende de qual thread a executou. Retorna 0 se faltou memória.
+int jogarPartidaTorneio(const ConfiguracaoTorneio* configuracao, long long numero, 
+                        Arena* arena, RelatorioTorneio* relatorio) {
+    long long curva[PONTOS_CURVA][MAX_JOGADORES_TORNEIO];
+    int amostras = 0, turno = 0;
+    
+    Jogo* partida = arena != NULL ? criarJogoNaArena(arena, configuracao->semente + (uint64_t)numero) : NULL;
+    if (partida == NULL || !gerarJogoSintetico(partida, configuracao->territorios, configuracao->numJogadores, 
+                                               configuracao->numCores, 1)) {
+        return 0;
+    }
+    Jogo jogo = *partida; // Cópia local: os ponteiros continuam apontando para a arena
+    Mapa* mapa = &jogo.mapa;
+    
+    // O sorteio do mapa pode já cumprir missões fáceis; anotadas à parte, sem
+    // encerrar a partida antes de qualquer jogada
+    uint8_t cumpridaNoSorteio[MAX_JOGADORES_TORNEIO];
+    int decididaNoSorteio = 0;
+    for (int j = 0; j < jogo.numJogadores; j++) {
+        cumpridaNoSorteio[j] = (uint8_t)verificarMissao(&jogo.jogadores[j].missao, mapa, jogo.jogadores[j].cor);
+        decididaNoSorteio |= cumpridaNoSorteio[j];
+    }
+    
+    jogo.vencedor = -1;
+    while (jogo.vencedor < 0 && turno < configuracao->maxTurnos) {
+        // Curva de tropas: total de cada jogador a cada PASSO_CURVA turnos
+        if (turno % PASSO_CURVA == 0 && amostras < PONTOS_CURVA) {
+            for (int j = 0; j < jogo.numJogadores; j++) {
+                curva[amostras][j] = mapa->agregados.tropas[jogo.jogadores[j].cor];
+            }
+            amostras++;
+        }
+        
+        int vez = turno % jogo.numJogadores;
+        uint8_t cor = jogo.jogadores[vez].cor;
+        const PoliticaAtaque* politica = &politicasTorneio[configuracao->politicas[vez]];
+        // No primeiro turno a vitória só é verificada depois de todas as jogadas
+        int verificarJogadas = turno > 0;
+        turno++;
+        if (mapa->agregados.territorios[cor] == 0) continue; // Jogador eliminado
+        
+        // Reforço do turno: metade dos territórios controlados, no mínimo 3
+        int reforco = mapa->agregados.territorios[cor] / 2;
+        int destino = politica->escolherReforco(mapa, cor, &jogo.gerador);
+        if (reforco < 3) reforco = 3;
+        if (destino >= 0) {
+            definirTropas(mapa, destino, mapa->tropas[destino] + reforco);
+            if (verificarJogadas) jogo.vencedor = encontrarVencedor(jogo.jogadores, jogo.numJogadores, mapa);
+        }
+        
+        for (int k = 0; k < ATAQUES_POR_TURNO && jogo.vencedor < 0; k++) {
+            int atacante, defensor;
+            if (!politica->escolherAtaque(mapa, cor, &jogo.gerador, &atacante, &defensor)) break;
+            int dadoAtacante = rolarDado(&jogo.gerador);
+            int dadoDefensor = rolarDado(&jogo.gerador);
+            resolverAtaque(mapa, atacante, defensor, dadoAtacante, dadoDefensor);
+            jogo.ataques++;
+            if (verificarJogadas) jogo.vencedor = encontrarVencedor(jogo.jogadores, jogo.numJogadores, mapa);
+        }
+        if (!verificarJogadas) jogo.vencedor = encontrarVencedor(jogo.jogadores, jogo.numJogadores, mapa);
+    }
+    
+    // Publicar os números da partida
+    registrarFimLog(&jogo);
+    atomic_fetch_add_explicit(&relatorio->partidas, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&relatorio->turnos, turno, memory_order_relaxed);
+    atomic_fetch_add_explicit(&relatorio->ataques, jogo.ataques, memory_order_relaxed);
+    long long maior = atomic_load_explicit(&relatorio->maiorPartida, memory_order_relaxed);
+    while (turno > maior && !atomic_compare_exchange_weak_explicit(&relatorio->maiorPartida, &maior, turno, 
+                                                                   memory_order_relaxed, memory_order_relaxed)) {
+    }
+    for (int j = 0; j < jogo.numJogadores; j++) {
+        atomic_fetch_add_explicit(&relatorio->sorteiosMissao[jogo.jogadores[j].missao.definicao], 1, 
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&relatorio->assentosPolitica[configuracao->politicas[j]], 1, 
+                                  memory_order_relaxed);
+    }
+    
+    if (decididaNoSorteio) {
+        atomic_fetch_add_explicit(&relatorio->decididasNoSorteio, 1, memory_order_relaxed);
+    }
+    if (jogo.vencedor < 0) {
+        atomic_fetch_add_explicit(&relatorio->semVencedor, 1, memory_order_relaxed);
+    } else {
+        int vencedor = jogo.vencedor;
+        if (cumpridaNoSorteio[vencedor]) {
+            atomic_fetch_add_explicit(&relatorio->vitoriasNoSorteio, 1, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&relatorio->vitoriasMissao[jogo.jogadores[vencedor].missao.definicao], 1, 
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&relatorio->vitoriasPolitica[configuracao->politicas[vencedor]], 1, 
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&relatorio->vitoriasAssento[vencedor], 1, memory_order_relaxed);
+        for (int p = 0; p < amostras; p++) {
+            long long demais = 0;
+            for (int j = 0; j < jogo.numJogadores; j++) {
+                if (j != vencedor) demais += curva[p][j];
+            }
+            atomic_fetch_add_explicit(&relatorio->curvaVencedor[p], curva[p][vencedor], memory_order_relaxed);
+            atomic_fetch_add_explicit(&relatorio->curvaDemais[p], 
+                                      jogo.numJogadores > 1 ? demais * 1000 / (jogo.numJogadores - 1) : 0, 
+                                      memory_order_relaxed);
+            atomic_fetch_add_explicit(&relatorio->amostrasCurva[p], 1, memory_order_relaxed);
+        }
+    }
+    
+    // Nada a liberar: a próxima partida reinicia a arena
+    return 1;
+}
+
+// Fila de trabalho de uma thread (deque de Chase-Lev). As partidas são
+// distribuídas em faixas contíguas, então a fila guarda só os limites:
+// o dono retira do fim (base) e as outras threads roubam do início (topo).
+typedef struct {
+    _Alignas(64) _Atomic long long topo;
+    _Atomic long long base;
+} FilaTrabalho;
+
+// Função para o dono retirar a próxima partida da própria fila (-1 se vazia)
+static long long retirarDaFila(FilaTrabalho* fila) {
+    long long base = atomic_load_explicit(&fila->base, memory_order_relaxed) - 1;
+    atomic_store_explicit(&fila->base, base, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long topo = atomic_load_explicit(&fila->topo, memory_order_relaxed);
+    
+    if (topo > base) {
+        // Fila vazia: desfaz a reserva
+        atomic_store_explicit(&fila->base, base + 1, memory_order_relaxed);
+        return -1;
+    }
+    if (topo == base) {
+        // Último item: disputa com possíveis ladrões
+        int venceu = atomic_compare_exchange_strong_explicit(&fila->topo, &topo, topo + 1, 
+                                                            memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&fila->base, base + 1, memory_order_relaxed);
+        return venceu ? base : -1;
+    }
+    return base;
+}
+
+// Função para roubar uma partida do início da fila de outra thread (-1 se não conseguiu)
+static long long roubarDaFila(FilaTrabalho* fila) {
+    long long topo = atomic_load_explicit(&fila->topo, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long base = atomic_load_explicit(&fila->base, memory_order_acquire);
+    
+    if (topo >= base) return -1;
+    if (!atomic_compare_exchange_strong_explicit(&fila->topo, &topo, topo + 1, 
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return -1; // Outra thread levou esta partida
+    }
+    return topo;
+}
+
+// Estado compartilhado pelas threads de um torneio
+typedef struct {
+    const ConfiguracaoTorneio* configuracao;
+    FilaTrabalho* filas;
+    int numThreads;
+    _Atomic long long restantes;    // Partidas ainda não concluídas
+    _Atomic int falhou;             // Alguma partida ficou sem memória
+    RelatorioTorneio relatorio;
+} Torneio;
+
+// Argumento de cada thread do torneio
+typedef struct {
+    Torneio* torneio;
+    int indice;
+    long long roubadas;
+} TrabalhadorTorneio;
+
+// Função executada por cada thread: esvazia a própria fila e depois rouba das outras
+void* executarTrabalhadorTorneio(void* argumento) {
+    TrabalhadorTorneio* trabalhador = (TrabalhadorTorneio*)argumento;
+    Torneio* torneio = trabalhador->torneio;
+    GeradorAleatorio gerador;
+    Arena arena;
+    
+    // O gerador só escolhe vítimas de roubo; as partidas têm sementes próprias
+    inicializarGerador(&gerador, torneio->configuracao->semente, (1ULL << 32) + trabalhador->indice);
+    // Uma arena por thread, com folga para as colunas, os nomes e o grafo em grade
+    int arenaPronta = criarArena(&arena, (size_t)torneio->configuracao->territorios * 256 + ((size_t)1 << 20));
+    
+    while (atomic_load_explicit(&torneio->restantes, memory_order_acquire) > 0) {
+        long long partida = retirarDaFila(&torneio->filas[trabalhador->indice]);
+        
+        for (int tentativa = 0; partida < 0 && tentativa < torneio->numThreads; tentativa++) {
+            int vitima = sortearIntervalo(&gerador, (uint32_t)torneio->numThreads);
+            if (vitima == trabalhador->indice) continue;
+            partida = roubarDaFila(&torneio->filas[vitima]);
+            if (partida >= 0) trabalhador->roubadas++;
+        }
+        if (partida < 0) {
+            sched_yield(); // Nada a fazer agora; as últimas partidas estão em andamento
+            continue;
+        }
+        
+        if (!jogarPartidaTorneio(torneio->configuracao, partida, arenaPronta ? &arena : NULL, 
+                                 &torneio->relatorio)) {
+            atomic_store_explicit(&torneio->falhou, 1, memory_order_relaxed);
+        }
+        atomic_fetch_sub_explicit(&torneio->restantes, 1, memory_order_acq_rel);
+    }
+    if (arenaPronta) destruirArena(&arena);
+    return NULL;
+}
+
+// Função para buscar uma política pelo nome (-1 se não existir)
+int buscarPolitica(const char* nome) {
+    for (int p = 0; p < TOTAL_POLITICAS; p++) {
+        if (strcmp(politicasTorneio[p].nome, nome) == 0) return p;
+    }
+    return -1;
+}
+
+// Função para imprimir o relatório final de um torneio
+void exibirRelatorioTorneio(Torneio* torneio, double duracao, long long roubadas) {
+    const ConfiguracaoTorneio* configuracao = torneio->configuracao;
+    RelatorioTorneio* relatorio = &torneio->relatorio;
+    long long partidas = relatorio->partidas;
+    char texto[128];
+    
+    printf("=== RELATÓRIO DO TORNEIO ===\n");
+    printf("Partidas: %lld (%d territórios, %d jogadores, %d cores, semente %llu)\n", 
+           partidas, configuracao->territorios, configuracao->numJogadores, configuracao->numCores, 
+           (unsigned long long)configuracao->semente);
+    printf("Sem vencedor após %d turnos: %lld\n", configuracao->maxTurnos, (long long)relatorio->semVencedor);
+    printf("Com missão já cumprida no sorteio do mapa: %lld (%.2f%%), %lld vencidas por essa missão\n", 
+           (long long)relatorio->decididasNoSorteio, 
+           partidas > 0 ? 100.0 * relatorio->decididasNoSorteio / partidas : 0.0, 
+           (long long)relatorio->vitoriasNoSorteio);
+    printf("Turnos por partida: %.2f em média, %lld no máximo\n", 
+           partidas > 0 ? (double)relatorio->turnos / partidas : 0.0, (long long)relatorio->maiorPartida);
+    printf("Ataques por partida: %.2f\n", partidas > 0 ? (double)relatorio->ataques / partidas : 0.0);
+    
+    printf("\nVitórias por missão (vitórias / vezes sorteada):\n");
+    for (int k = 0; k < TOTAL_MISSOES; k++) {
+        Missao missao = {missoesPredefinidas[k].tipo, missoesPredefinidas[k].parametro, k, -1, -1};
+        long long sorteios = relatorio->sorteiosMissao[k];
+        descreverMissao(&missao, texto, sizeof(texto));
+        printf("- %-60s %8lld / %-8lld (%.2f%%)\n", texto, (long long)relatorio->vitoriasMissao[k], sorteios, 
+               sorteios > 0 ? 100.0 * relatorio->vitoriasMissao[k] / sorteios : 0.0);
+    }
+    
+    printf("\nVitórias por política (vitórias / assentos):\n");
+    for (int p = 0; p < TOTAL_POLITICAS; p++) {
+        long long assentos = relatorio->assentosPolitica[p];
+        if (assentos == 0) continue;
+        printf("- %-10s %8lld / %-8lld (%.2f%%)\n", politicasTorneio[p].nome, 
+               (long long)relatorio->vitoriasPolitica[p], assentos, 
+               100.0 * relatorio->vitoriasPolitica[p] / assentos);
+    }
+    
+    printf("\nVitórias por assento:\n");
+    for (int j = 0; j < configuracao->numJogadores; j++) {
+        printf("- Jogador %d (%s): %lld\n", j + 1, politicasTorneio[configuracao->politicas[j]].nome, 
+               (long long)relatorio->vitoriasAssento[j]);
+    }
+    
+    printf("\nCurva de tropas nas partidas com vencedor (média por turno):\n");
+    for (int p = 0; p < PONTOS_CURVA && relatorio->amostrasCurva[p] > 0; p++) {
+        long long amostras = relatorio->amostrasCurva[p];
+        printf("- turno %4d: vencedor %8.2f | demais %8.2f (%lld partidas)\n", p * PASSO_CURVA, 
+               (double)relatorio->curvaVencedor[p] / amostras, 
+               (double)relatorio->curvaDemais[p] / 1000.0 / amostras, amostras);
+    }
+    
+    printf("\nThreads: %d | partidas roubadas entre filas: %lld\n", torneio->numThreads, roubadas);
+    printf("Tempo: %.3f s (%.0f partidas/s)\n", duracao, duracao > 0 ? partidas / duracao : 0.0);
+}
+
+// Modo de linha de comando:
+// war --torneio <partidas> [threads] [--territorios N] [--jogadores N] [--cores N]
+//                [--politicas p1,p2,...] [--turnos N] [--semente S]
+int executarModoTorneio(int argc, char* argv[]) {
+    ConfiguracaoTorneio configuracao = {42, 4, 4, 2000, (uint64_t)time(NULL), {0}};
+    const char* politicas = "aleatoria,gulosa";
+    int numThreads = 0;
+    
+    if (argc < 3 || atoll(argv[2]) < 1) {
+        printf("Uso: %s --torneio <partidas> [threads] [--territorios N] [--jogadores N] [--cores N] "
+               "[--politicas p1,p2,...] [--turnos N] [--semente S]\n", argv[0]);
+        return 1;
+    }
+    long long numPartidas = atoll(argv[2]);
+    
+    for (int i = 3; i < argc; i++) {
+        int temValor = i + 1 < argc;
+        if (strcmp(argv[i], "--territorios") == 0 && temValor) configuracao.territorios = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--jogadores") == 0 && temValor) configuracao.numJogadores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cores") == 0 && temValor) configuracao.numCores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--politicas") == 0 && temValor) politicas = argv[++i];
+        else if (strcmp(argv[i], "--turnos") == 0 && temValor) configuracao.maxTurnos = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--semente") == 0 && temValor) configuracao.semente = strtoull(argv[++i], NULL, 10);
+        else numThreads = atoi(argv[i]);
+    }
+    if (configuracao.numCores < configuracao.numJogadores) configuracao.numCores = configuracao.numJogadores;
+    if (configuracao.numJogadores < 2 || configuracao.numJogadores > MAX_JOGADORES_TORNEIO || 
+        configuracao.numCores >= MAX_CORES || configuracao.territorios < configuracao.numJogadores || 
+        configuracao.maxTurnos < 1) {
+        printf("Erro: use de 2 a %d jogadores, menos de %d cores e ao menos um território por jogador!\n", 
+               MAX_JOGADORES_TORNEIO, MAX_CORES);
+        return 1;
+    }
+    
+    // Políticas atribuídas aos assentos em rodízio
+    char lista[128];
+    int totalPoliticas = 0, escolhidas[MAX_JOGADORES_TORNEIO];
+    snprintf(lista, sizeof(lista), "%s", politicas);
+    for (char* nome = strtok(lista, ","); nome != NULL; nome = strtok(NULL, ",")) {
+        int politica = buscarPolitica(nome);
+        if (politica < 0 || totalPoliticas == MAX_JOGADORES_TORNEIO) {
+            printf("Erro: política '%s' desconhecida (use aleatoria ou gulosa)!\n", nome);
+            return 1;
+        }
+        escolhidas[totalPoliticas++] = politica;
+    }
+    for (int j = 0; j < configuracao.numJogadores; j++) {
+        configuracao.politicas[j] = escolhidas[j % totalPoliticas];
+    }
+    
+    if (numThreads <= 0) numThreads = contarNucleos();
+    if (numThreads > MAX_THREADS_SIMULACAO) numThreads = MAX_THREADS_SIMULACAO;
+    if (numThreads > numPartidas) numThreads = (int)numPartidas;
+    
+    Torneio* torneio = (Torneio*)calloc(1, sizeof(Torneio));
+    FilaTrabalho* filas = (FilaTrabalho*)aligned_alloc(64, numThreads * sizeof(FilaTrabalho));
+    TrabalhadorTorneio trabalhadores[MAX_THREADS_SIMULACAO];
+    pthread_t threads[MAX_THREADS_SIMULACAO];
+    if (torneio == NULL || filas == NULL) {
+        printf("Erro: Falha na alocação de memória para o torneio!\n");
+        exit(1);
+    }
+    
+    // Cada thread começa com uma faixa contígua de partidas
+    torneio->configuracao = &configuracao;
+    torneio->filas = filas;
+    torneio->numThreads = numThreads;
+    atomic_init(&torneio->restantes, numPartidas);
+    for (int t = 0; t < numThreads; t++) {
+        atomic_init(&filas[t].topo, numPartidas * t / numThreads);
+        atomic_init(&filas[t].base, numPartidas * (t + 1) / numThreads);
+    }
+    
+    double inicio = tempoAtual();
+    int criadas = 0;
+    for (; criadas < numThreads; criadas++) {
+        trabalhadores[criadas].torneio = torneio;
+        trabalhadores[criadas].indice = criadas;
+        trabalhadores[criadas].roubadas = 0;
+        if (pthread_create(&threads[criadas], NULL, executarTrabalhadorTorneio, &trabalhadores[criadas]) != 0) {
+            break;
+        }
+    }
+    if (criadas == 0) {
+        printf("Erro: Não foi possível criar as threads do torneio!\n");
+        free(filas);
+        free(torneio);
+        return 1;
+    }
+    // Se faltaram threads, as criadas roubam as faixas das que não existem
+    long long roubadas = 0;
+    for (int t = 0; t < criadas; t++) {
+        pthread_join(threads[t], NULL);
+        roubadas += trabalhadores[t].roubadas;
+    }
+    double duracao = tempoAtual() - inicio;
+    
+    int falhou = atomic_load(&torneio->falhou);
+    if (falhou) {
+        printf("Erro: Algumas partidas não puderam ser geradas por falta de memória!\n");
+    }
+    exibirRelatorioTorneio(torneio, duracao, roubadas);
+    free(filas);
+    free(torneio);
+    return falhou ? 1 : 0;
+}
+
+// Robôs do modo de turnos simultâneos
+typedef struct {
+    ResolvedorTurno* resolvedor;
+    OrdemAtaque* ordens;                // Cada fatia escreve a partir de fatia * TERRITORIOS_POR_FATIA
+    int* ordensFatia;                   // Ordens geradas em cada fatia
+    uint8_t jogadorDaCor[MAX_CORES];    // 1 se a cor é de um jogador (as outras são neutras)
+    uint64_t semente;                   // Semente dos robôs no turno
+} RobosSimultaneos;
+
+// Tarefa por fatia: reforços e ordens dos robôs. Cada território de um jogador
+// recebe 1 tropa com chance 1/2 (em média metade dos territórios, como no
+// torneio) e, com 2 ou mais tropas, ataca um vizinho inimigo sorteado. Os
+// reforços entram nas parciais e vão para os agregados junto com o turno.
+static void gerarOrdensFatia(void* contexto, int fatia, int trabalhador) {
+    RobosSimultaneos* robos = (RobosSimultaneos*)contexto;
+    Mapa* mapa = robos->resolvedor->mapa;
+    ParcialTurno* parcial = &robos->resolvedor->parciais[trabalhador];
+    OrdemAtaque* saida = robos->ordens + (size_t)fatia * TERRITORIOS_POR_FATIA;
+    int inicio = fatia * TERRITORIOS_POR_FATIA;
+    int fim = inicio + TERRITORIOS_POR_FATIA;
+    int total = 0;
+    GeradorAleatorio gerador;
+    
+    if (fim > mapa->quantidade) fim = mapa->quantidade;
+    inicializarGerador(&gerador, robos->semente, (uint64_t)fatia);
+    for (int t = inicio; t < fim; t++) {
+        uint8_t cor = mapa->cor[t];
+        if (!robos->jogadorDaCor[cor]) continue;
+        if (proximoAleatorio(&gerador) & 1) alterarTropasTurno(mapa, parcial, t, mapa->tropas[t] + 1);
+        if (mapa->tropas[t] < 2) continue;
+        
+        int implicitos[2];
+        const int* vizinhos;
+        int grau = listarVizinhos(mapa, t, &vizinhos, implicitos);
+        int alvo = -1, vistos = 0;
+        for (int i = 0; i < grau; i++) {
+            if (mapa->cor[vizinhos[i]] == cor) continue;
+            if (sortearIntervalo(&gerador, (uint32_t)++vistos) == 0) alvo = vizinhos[i];
+        }
+        if (alvo < 0) continue;
+        saida[total].atacante = t;
+        saida[total].defensor = alvo;
+        saida[total].cor = cor;
+        saida[total].situacao = ORDEM_CANCELADA;
+        total++;
+    }
+    robos->ordensFatia[fatia] = total;
+}
+
+// Função para resumir as colunas de dono e tropas em 64 bits (FNV-1a)
+static uint64_t assinarMapa(const Mapa* mapa) {
+    uint64_t assinatura = 1469598103934665603ULL;
+    for (int t = 0; t < mapa->quantidade; t++) {
+        assinatura = (assinatura ^ mapa->cor[t]) * 1099511628211ULL;
+        assinatura = (assinatura ^ (uint32_t)mapa->tropas[t]) * 1099511628211ULL;
+    }
+    return assinatura;
+}
+
+// Função para preparar os robôs sobre um resolvedor já criado: vetor de ordens
+// (uma faixa por fatia) e cores dos jogadores. Retorna 0 se faltou memória.
+static int prepararRobosSimultaneos(RobosSimultaneos* robos, ResolvedorTurno* resolvedor, const Jogo* jogo) {
+    memset(robos, 0, sizeof(RobosSimultaneos));
+    robos->resolvedor = resolvedor;
+    robos->ordens = (OrdemAtaque*)malloc((size_t)resolvedor->numFatias * TERRITORIOS_POR_FATIA * sizeof(OrdemAtaque));
+    robos->ordensFatia = (int*)malloc(resolvedor->numFatias * sizeof(int));
+    if (robos->ordens == NULL || robos->ordensFatia == NULL) return 0;
+    for (int j = 0; j < jogo->numJogadores; j++) {
+        robos->jogadorDaCor[jogo->jogadores[j].cor] = 1;
+    }
+    return 1;
+}
+
+// Função para jogar turnos dos robôs até alguém vencer (se 'verificarVitoria')
+// ou até 'maxTurnos'. A vitória só é verificada no fim de cada turno, nunca no
+// mapa recém-sorteado (que já cumpre missões fáceis). Os totais, as ordens
+// enviadas e os tempos de cada fase são somados aos valores recebidos.
+// Retorna o número de turnos jogados.
+static int jogarTurnosSimultaneos(Jogo* jogo, RobosSimultaneos* robos, int maxTurnos, int verificarVitoria, 
+                                  uint64_t semente, ResumoTurno* totais, long long* enviadas, 
+                                  double* tempoRobos, double* tempoResolucao) {
+    ResolvedorTurno* resolvedor = robos->resolvedor;
+    int numFatias = resolvedor->numFatias;
+    int turno = 0;
+    while (jogo->vencedor < 0 && turno < maxTurnos) {
+        // Sementes do turno: uma para os robôs e outra para os dados das ordens
+        uint64_t estado = semente + (uint64_t)turno++;
+        robos->semente = splitmix64(&estado);
+        uint64_t sementeTurno = splitmix64(&estado);
+        
+        double inicio = tempoAtual();
+        executarPorFatias(resolvedor->grupo, numFatias, gerarOrdensFatia, robos);
+        // Juntar as ordens no início do vetor, na ordem das fatias
+        long long total = 0;
+        for (int f = 0; f < numFatias; f++) {
+            memmove(robos->ordens + total, robos->ordens + (size_t)f * TERRITORIOS_POR_FATIA, 
+                    robos->ordensFatia[f] * sizeof(OrdemAtaque));
+            total += robos->ordensFatia[f];
+        }
+        double meio = tempoAtual();
+        ResumoTurno resumo = resolverTurnoSimultaneo(resolvedor, robos->ordens, total, sementeTurno);
+        *tempoRobos += meio - inicio;
+        *tempoResolucao += tempoAtual() - meio;
+        
+        *enviadas += total;
+        totais->executadas += resumo.executadas;
+        totais->conquistas += resumo.conquistas;
+        totais->canceladas += resumo.canceladas;
+        totais->entreFatias += resumo.entreFatias;
+        jogo->ataques += resumo.executadas;
+        // Uma única verificação de vitória por turno
+        if (verificarVitoria) {
+            jogo->vencedor = encontrarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+        }
+    }
+    return turno;
+}
+
+// Modo de linha de comando:
+// war --simultaneo [threads] [--territorios N] [--jogadores N] [--cores N] [--turnos N] [--semente S]
+//                   [--vitoria]
+// Uma partida sintética (grade de fronteiras) entre robôs que dão ordens em
+// todos os territórios a cada turno. A assinatura final do mapa depende só da
+// semente e dos parâmetros, não do número de threads. Por padrão todos os
+// turnos são jogados sem verificar missões (em mapas grandes as missões fáceis
+// se cumprem já no primeiro turno); --vitoria encerra a partida no fim do
+// turno em que alguém cumprir a sua.
+int executarModoSimultaneo(int argc, char* argv[]) {
+    int territorios = 1000000, numJogadores = 16, numCores = 0, maxTurnos = 20, numThreads = 0;
+    int verificarVitoria = 0;
+    uint64_t semente = (uint64_t)time(NULL);
+    
+    for (int i = 2; i < argc; i++) {
+        int temValor = i + 1 < argc;
+        if (strcmp(argv[i], "--territorios") == 0 && temValor) territorios = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--jogadores") == 0 && temValor) numJogadores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cores") == 0 && temValor) numCores = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--turnos") == 0 && temValor) maxTurnos = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--semente") == 0 && temValor) semente = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--vitoria") == 0) verificarVitoria = 1;
+        else if (strcmp(argv[i], "--sem-vitoria") == 0) verificarVitoria = 0;
+        else numThreads = atoi(argv[i]);
+    }
+    if (numCores < numJogadores) numCores = numJogadores;
+    if (numJogadores < 2 || numCores >= MAX_CORES || territorios < numJogadores || 
+        territorios > 100000000 || maxTurnos < 1) {
+        printf("Uso: %s --simultaneo [threads] [--territorios N] [--jogadores N] [--cores N] [--turnos N] "
+               "[--semente S] [--vitoria]\n(de 2 jogadores a menos de %d cores, até 10^8 territórios)\n", argv[0], MAX_CORES);
+        return 1;
+    }
+    if (numThreads <= 0) numThreads = contarNucleos();
+    if (numThreads > MAX_THREADS_SIMULACAO) numThreads = MAX_THREADS_SIMULACAO;
+    
+    // Partida em uma arena, com folga para as colunas, os nomes e o grafo em grade
+    Arena arena;
+    if (!criarArena(&arena, (size_t)territorios * 256 + ((size_t)1 << 20))) {
+        printf("Erro: Não foi possível reservar memória para %d territórios!\n", territorios);
+        return 1;
+    }
+    double inicio = tempoAtual();
+    Jogo* jogo = criarJogoNaArena(&arena, semente);
+    if (jogo == NULL || !gerarJogoSintetico(jogo, territorios, numJogadores, numCores, 1)) {
+        printf("Erro: Não foi possível gerar o mapa com %d territórios!\n", territorios);
+        destruirArena(&arena);
+        return 1;
+    }
+    double geracao = tempoAtual() - inicio;
+    
+    ResolvedorTurno resolvedor;
+    RobosSimultaneos robos;
+    int ok = criarResolvedorTurno(&resolvedor, &jogo->mapa, numThreads);
+    int numFatias = resolvedor.numFatias;
+    if (!ok || !prepararRobosSimultaneos(&robos, &resolvedor, jogo)) {
+        printf("Erro: Falha na alocação de memória para os turnos!\n");
+        exit(1);
+    }
+    
+    ResumoTurno totais = {0, 0, 0, 0};
+    long long enviadas = 0;
+    double tempoRobos = 0, tempoResolucao = 0;
+    int turno = jogarTurnosSimultaneos(jogo, &robos, maxTurnos, verificarVitoria, semente, &totais, &enviadas, 
+                                       &tempoRobos, &tempoResolucao);
+    registrarFimLog(jogo);
+    
+    printf("=== TURNOS SIMULTÂNEOS ===\n");
+    printf("Mapa: %d territórios em %d fatias de até %d, %d jogadores, %d cores, semente %llu (gerado em %.3f s)\n", 
+           territorios, numFatias, TERRITORIOS_POR_FATIA, numJogadores, numCores, 
+           (unsigned long long)semente, geracao);
+    if (jogo->vencedor >= 0) {
+        char texto[128];
+        const Jogador* vencedor = &jogo->jogadores[jogo->vencedor];
+        descreverMissao(&vencedor->missao, texto, sizeof(texto));
+        printf("Turnos: %d | vencedor: %s (%s), missão \"%s\"\n", turno, vencedor->nome, 
+               nomeCor(&jogo->mapa.cores, vencedor->cor), texto);
+    } else {
+        printf("Turnos: %d | sem vencedor\n", turno);
+    }
+    printf("Ordens: %lld enviadas, %lld executadas (%lld conquistas), %lld canceladas\n", 
+           enviadas, totais.executadas, totais.conquistas, totais.canceladas);
+    printf("Ordens entre fatias (resolvidas em série): %lld (%.2f%%)\n", totais.entreFatias, 
+           enviadas > 0 ? 100.0 * totais.entreFatias / enviadas : 0.0);
+    printf("\nJogadores no fim:\n");
+    for (int j = 0; j < jogo->numJogadores; j++) {
+        uint8_t cor = jogo->jogadores[j].cor;
+        printf("- %-4s (%-8s): %9d territórios, %11lld tropas\n", jogo->jogadores[j].nome, 
+               nomeCor(&jogo->mapa.cores, cor), jogo->mapa.agregados.territorios[cor], 
+               jogo->mapa.agregados.tropas[cor]);
+    }
+    printf("\nAssinatura do mapa: %016llx\n", (unsigned long long)assinarMapa(&jogo->mapa));
+    printf("Threads: %d | robôs %.3f s | resolução %.3f s (%.0f ordens/s)\n", resolvedor.numThreads, tempoRobos, 
+           tempoResolucao, tempoResolucao > 0 ? enviadas / tempoResolucao : 0.0);
+    
+    free(robos.ordens);
+    free(robos.ordensFatia);
+    liberarResolvedorTurno(&resolvedor);
+    destruirArena(&arena);
+    return 0;
+}
+
+// Parâmetros da autoverificação (war --verificar): mapas pequenos o bastante
+// para o modo terminar em poucos segundos, grandes o bastante para ter várias
+// fatias e blocos vetoriais
+#define MAPAS_VERIFICACAO 40
+#define TERRITORIOS_VERIFICACAO 200000
+#define TURNOS_VERIFICACAO 5
+#define BATALHAS_VERIFICACAO 200000
+#define ATAQUES_VERIFICACAO 50000
+
+// Função auxiliar para começar uma partida sintética fora de arena, sem
+// registrar missões e jogadas no log (não são partidas de verdade)
+static int gerarJogoVerificacao(Jogo* jogo, uint64_t semente, int territorios, int numJogadores, 
+                                int numCores, int comFronteiras) {
+    iniciarJogo(jogo, semente);
+    jogo->mapa.partidaLog = 0;
+    return gerarJogoSintetico(jogo, territorios, numJogadores, numCores, comFronteiras);
+}
+
+// Verificação: todas as versões suportadas da varredura devolvem os mesmos
+// resumos que a escalar, em mapas de tamanhos e cores sorteados (alguns com
+// tropas acima de LIMITE_TROPAS_VETORIAL, que forçam o caminho escalar no bloco).
+// Retorna o número de divergências.
+static int verificarVersoesVarredura(uint64_t semente) {
+    GeradorAleatorio gerador;
+    int falhas = 0;
+    inicializarGerador(&gerador, semente, 1);
+    
+    for (int caso = 0; caso < MAPAS_VERIFICACAO; caso++) {
+        int numCores = 2 + sortearIntervalo(&gerador, MAX_CORES - 2);
+        int numJogadores = 1 + sortearIntervalo(&gerador, (uint32_t)numCores);
+        int territorios = numJogadores + sortearIntervalo(&gerador, 3 * BLOCO_VARREDURA + 7);
+        Jogo jogo;
+        if (!gerarJogoVerificacao(&jogo, semente + caso, territorios, numJogadores, numCores, 0)) {
+            printf("  mapa %d não pôde ser gerado\n", caso);
+            encerrarJogo(&jogo);
+            return falhas + 1;
+        }
+        if (caso % 4 == 3) {
+            for (int k = 0; k < 8; k++) {
+                definirTropas(&jogo.mapa, sortearIntervalo(&gerador, (uint32_t)territorios), 
+                              LIMITE_TROPAS_VETORIAL + sortearIntervalo(&gerador, 1000));
+            }
+        }
+        
+        // Todas as cores, em ordem inversa, ou um subconjunto sorteado
+        uint8_t cores[MAX_CORES];
+        int totalCores = 0;
+        for (int c = jogo.mapa.cores.total - 1; c >= 0; c--) {
+            if (caso % 2 == 0 || (proximoAleatorio(&gerador) & 1) || (c == 0 && totalCores == 0)) {
+                cores[totalCores++] = (uint8_t)c;
+            }
+        }
+        
+        ResumoCor referencia[MAX_CORES], resumos[MAX_CORES];
+        varrerColunasEscalar(&jogo.mapa, cores, totalCores, referencia);
+        for (int v = 0; v < TOTAL_VERSOES_VARREDURA; v++) {
+            if (!versaoVarreduraSuportada(v) || versoesVarredura[v].varrer == varrerColunasEscalar) continue;
+            versoesVarredura[v].varrer(&jogo.mapa, cores, totalCores, resumos);
+            if (memcmp(referencia, resumos, (size_t)totalCores * sizeof(ResumoCor)) != 0) {
+                printf("  %s difere da escalar: %d territórios, %d cores pedidas\n", 
+                       versoesVarredura[v].nome, territorios, totalCores);
+                falhas++;
+            }
+        }
+        encerrarJogo(&jogo);
+    }
+    return falhas;
+}
+
+// Verificação: a auditoria de vitória (colunas e grafo) concorda com os
+// verificadores pelos agregados, para cada missão da tabela e cada jogador,
+// em mapas com e sem fronteiras alterados por trocas de dono e de tropas.
+// Retorna o número de divergências.
+static int verificarAuditoriaVitoria(uint64_t semente) {
+    GeradorAleatorio gerador;
+    int falhas = 0;
+    inicializarGerador(&gerador, semente, 2);
+    
+    for (int caso = 0; caso < MAPAS_VERIFICACAO; caso++) {
+        int territorios = 4 + sortearIntervalo(&gerador, 300);
+        Jogo jogo;
+        if (!gerarJogoVerificacao(&jogo, semente + caso, territorios, 3, 4, caso % 2)) {
+            printf("  mapa %d não pôde ser gerado\n", caso);
+            encerrarJogo(&jogo);
+            return falhas + 1;
+        }
+        for (int passo = 0; passo < 20; passo++) {
+            int t = sortearIntervalo(&gerador, (uint32_t)territorios);
+            definirDono(&jogo.mapa, t, (uint8_t)sortearIntervalo(&gerador, (uint32_t)jogo.mapa.cores.total));
+            definirTropas(&jogo.mapa, t, 1 + sortearIntervalo(&gerador, 2 * LIMITE_TROPAS_MISSAO));
+            
+            for (int i = 0; i < jogo.numJogadores; i++) {
+                for (int k = 0; k < TOTAL_MISSOES; k++) {
+                    const DefinicaoMissao* definicao = &missoesPredefinidas[k];
+                    Jogador jogador = jogo.jogadores[i];
+                    jogador.venceu = 0;
+                    jogador.missao.tipo = definicao->tipo;
+                    jogador.missao.parametro = definicao->parametro;
+                    jogador.missao.definicao = k;
+                    jogador.missao.corAlvo = definicao->tipo == MISSAO_ELIMINAR_COR 
+                                             ? buscarCor(&jogo.mapa.cores, definicao->alvo) : -1;
+                    jogador.missao.territorioAlvo = definicao->tipo == MISSAO_TERRITORIO 
+                                                    ? buscarTerritorio(&jogo.mapa, definicao->alvo) : -1;
+                    int pelosAgregados = verificarMissao(&jogador.missao, &jogo.mapa, jogador.cor);
+                    int pelaAuditoria = encontrarVencedorVarredura(&jogador, 1, &jogo.mapa) == 0;
+                    if (pelosAgregados != pelaAuditoria) {
+                        if (falhas < 5) {
+                            printf("  missão %d, jogador %d, mapa %d: agregados %d, auditoria %d\n", 
+                                   k + 1, i, caso, pelosAgregados, pelaAuditoria);
+                        }
+                        falhas++;
+                    }
+                }
+            }
+        }
+        encerrarJogo(&jogo);
+    }
+    return falhas;
+}
+
+// Função auxiliar para comparar uma frequência simulada com a probabilidade
+// exata: aceita até 5 desvios-padrão da proporção (comparados ao quadrado)
+static int frequenciaCompativel(double exata, long long sucessos, long long tentativas) {
+    double simulada = (double)sucessos / tentativas;
+    double diferenca = simulada - exata;
+    return diferenca * diferenca <= 25 * exata * (1 - exata) / tentativas + 1e-12;
+}
+
+// Verificação: as chances exatas de conquista (uma rolagem, até conquistar e
+// regra clássica) ficam dentro da tolerância da frequência simulada pelo
+// próprio código do jogo (simulação em massa e ataque relâmpago).
+// Retorna o número de divergências.
+static int verificarChances(uint64_t semente, int numThreads) {
+    static const int pares[][2] = {{2, 1}, {3, 1}, {4, 3}, {8, 8}, {12, 5}};
+    int falhas = 0;
+    
+    // Dois territórios de cores diferentes, recolocados antes de cada ataque
+    Jogo jogo;
+    iniciarJogo(&jogo, semente);
+    jogo.mapa.partidaLog = 0;
+    Territorio atacante = {"Atacante", "A", 1};
+    Territorio defensor = {"Defensor", "D", 1};
+    if (!reservarTerritorios(&jogo.mapa, 2)) {
+        printf("  faltou memória para o mapa dos ataques\n");
+        return 1;
+    }
+    adicionarTerritorio(&jogo.mapa, &atacante);
+    adicionarTerritorio(&jogo.mapa, &defensor);
+    uint8_t corDefensor = jogo.mapa.cor[1];
+    
+    for (size_t p = 0; p < sizeof(pares) / sizeof(pares[0]); p++) {
+        atacante.tropas = pares[p][0];
+        defensor.tropas = pares[p][1];
+        
+        EstatisticasSimulacao estatisticas;
+        if (!simularBatalhas(&atacante, &defensor, BATALHAS_VERIFICACAO, numThreads, semente + p, &estatisticas)) {
+            printf("  não foi possível criar as threads da simulação\n");
+            falhas++;
+            break;
+        }
+        ChancesAtaque rodada = calcularChancesRodada(atacante.tropas, defensor.tropas);
+        if (!frequenciaCompativel(rodada.conquista, estatisticas.vitoriasAtacante, estatisticas.batalhas)) {
+            printf("  uma rolagem %dx%d: exata %.4f, simulada %.4f\n", atacante.tropas, defensor.tropas, 
+                   rodada.conquista, (double)estatisticas.vitoriasAtacante / estatisticas.batalhas);
+            falhas++;
+        }
+        
+        for (int regra = DADOS_UM_A_UM; regra <= DADOS_CLASSICOS; regra++) {
+            ChancesAtaque exatas = regra == DADOS_CLASSICOS 
+                                   ? calcularChancesClassicas(atacante.tropas, defensor.tropas, NULL)
+                                   : calcularChancesAteConquista(atacante.tropas, defensor.tropas);
+            long long conquistas = 0;
+            for (int i = 0; i < ATAQUES_VERIFICACAO; i++) {
+                definirDono(&jogo.mapa, 1, corDefensor);
+                definirTropas(&jogo.mapa, 0, atacante.tropas);
+                definirTropas(&jogo.mapa, 1, defensor.tropas);
+                conquistas += resolverBlitz(&jogo.mapa, 0, 1, &jogo.gerador, (RegraDados)regra, 0).conquistou;
+            }
+            if (!frequenciaCompativel(exatas.conquista, conquistas, ATAQUES_VERIFICACAO)) {
+                printf("  até conquistar%s %dx%d: exata %.4f, simulada %.4f\n", 
+                       regra == DADOS_CLASSICOS ? " (clássica)" : "", atacante.tropas, defensor.tropas, 
+                       exatas.conquista, (double)conquistas / ATAQUES_VERIFICACAO);
+                falhas++;
+            }
+        }
+    }
+    encerrarJogo(&jogo);
+    return falhas;
+}
+
+// Verificação: desfazer todas as jogadas pelo diário devolve a assinatura, os
+// agregados e os aliados do início, e refazer todas devolve os do fim, com e
+// sem fronteiras. Retorna o número de divergências.
+static int verificarDesfazerRefazer(uint64_t semente) {
+    int falhas = 0;
+    for (int comFronteiras = 0; comFronteiras <= 1; comFronteiras++) {
+        Jogo jogo;
+        DiarioJogadas diario;
+        int territorios = 2000;
+        memset(&diario, 0, sizeof(diario));
+        if (!gerarJogoVerificacao(&jogo, semente, territorios, 4, 6, comFronteiras)) {
+            printf("  mapa não pôde ser gerado\n");
+            encerrarJogo(&jogo);
+            return falhas + 1;
+        }
+        jogo.mapa.diario = &diario;
+        
+        size_t tamanhoAliados = (size_t)territorios * sizeof(int);
+        AgregadosMapa agregadosInicio = jogo.mapa.agregados, agregadosFim;
+        int* aliadosInicio = (int*)malloc(tamanhoAliados);
+        int* aliadosFim = (int*)malloc(tamanhoAliados);
+        if (aliadosInicio == NULL || aliadosFim == NULL) {
+            printf("Erro: Falha na alocação de memória para a verificação!\n");
+            exit(1);
+        }
+        memcpy(aliadosInicio, jogo.mapa.aliados, tamanhoAliados);
+        uint64_t assinaturaInicio = assinarMapa(&jogo.mapa);
+        
+        // Reforços, ataques de uma rolagem e ataques relâmpago das duas regras
+        int jogadas = 0;
+        for (int passo = 0; passo < 3 * territorios; passo++) {
+            int t = sortearIntervalo(&jogo.gerador, (uint32_t)territorios);
+            int implicitos[2];
+            const int* vizinhos;
+            int grau = listarVizinhos(&jogo.mapa, t, &vizinhos, implicitos);
+            if (passo % 3 == 0 || jogo.mapa.tropas[t] < 2 || grau == 0) {
+                definirTropas(&jogo.mapa, t, jogo.mapa.tropas[t] + 3);
+                marcarJogada(&diario);
+            } else {
+                int alvo = vizinhos[sortearIntervalo(&jogo.gerador, (uint32_t)grau)];
+                if (passo % 3 == 1) {
+                    resolverAtaque(&jogo.mapa, t, alvo, rolarDado(&jogo.gerador), rolarDado(&jogo.gerador));
+                } else {
+                    resolverBlitz(&jogo.mapa, t, alvo, &jogo.gerador, 
+                                  passo % 2 ? DADOS_CLASSICOS : DADOS_UM_A_UM, 0);
+                }
+            }
+            jogadas++;
+        }
+        agregadosFim = jogo.mapa.agregados;
+        memcpy(aliadosFim, jogo.mapa.aliados, tamanhoAliados);
+        uint64_t assinaturaFim = assinarMapa(&jogo.mapa);
+        
+        while (desfazerJogada(&jogo.mapa) > 0) {}
+        if (assinarMapa(&jogo.mapa) != assinaturaInicio || 
+            memcmp(&jogo.mapa.agregados, &agregadosInicio, sizeof(AgregadosMapa)) != 0 ||
+            memcmp(jogo.mapa.aliados, aliadosInicio, tamanhoAliados) != 0) {
+            printf("  %s fronteiras: desfazer %d jogadas não voltou ao início\n", 
+                   comFronteiras ? "com" : "sem", jogadas);
+            falhas++;
+        }
+        while (refazerJogada(&jogo.mapa) > 0) {}
+        if (assinarMapa(&jogo.mapa) != assinaturaFim || 
+            memcmp(&jogo.mapa.agregados, &agregadosFim, sizeof(AgregadosMapa)) != 0 ||
+            memcmp(jogo.mapa.aliados, aliadosFim, tamanhoAliados) != 0) {
+            printf("  %s fronteiras: refazer %d jogadas não voltou ao fim\n", 
+                   comFronteiras ? "com" : "sem", jogadas);
+            falhas++;
+        }
+        
+        free(aliadosInicio);
+        free(aliadosFim);
+        free(diario.registros);
+        jogo.mapa.diario = NULL;
+        encerrarJogo(&jogo);
+    }
+    return falhas;
+}
+
+// Verificação: salvar um snapshot em um arquivo temporário e carregá-lo em
+// outra partida devolve o mesmo estado (jogadores, colunas, nomes e índice,
+// grafo, aliados e agregados). Retorna o número de divergências.
+static int verificarSnapshot(uint64_t semente) {
+    const char* diretorio = getenv("TMPDIR");
+    char caminho[4096];
+    int territorios = 3000;
+    Jogo original, carregado;
+    
+    if (!gerarJogoVerificacao(&original, semente, territorios, 4, 6, 1)) {
+        printf("  mapa não pôde ser gerado\n");
+        encerrarJogo(&original);
+        return 1;
+    }
+    for (int passo = 0; passo < territorios; passo++) {
+        int t = sortearIntervalo(&original.gerador, (uint32_t)territorios);
+        definirDono(&original.mapa, t, (uint8_t)sortearIntervalo(&original.gerador, 
+                                                                 (uint32_t)original.mapa.cores.total));
+        definirTropas(&original.mapa, t, 1 + sortearIntervalo(&original.gerador, 40));
+    }
+    original.jogadores[1].venceu = 1;
+    original.vencedor = 1;
+    
+    snprintf(caminho, sizeof(caminho), "%s/war-verificar-XXXXXX", diretorio != NULL ? diretorio : "/tmp");
+    int descritor = mkstemp(caminho);
+    if (descritor < 0) {
+        printf("  não foi possível criar um arquivo temporário em '%s'\n", caminho);
+        encerrarJogo(&original);
+        return 1;
+    }
+    close(descritor);
+    iniciarJogo(&carregado, semente);
+    carregado.mapa.partidaLog = 0;
+    int carregou = salvarSnapshot(&original, caminho) && carregarSnapshot(&carregado, caminho);
+    unlink(caminho);
+    if (!carregou) {
+        printf("  não foi possível salvar e carregar o snapshot\n");
+        encerrarJogo(&original);
+        encerrarJogo(&carregado);
+        return 1;
+    }
+    
+    const Mapa* a = &original.mapa;
+    const Mapa* b = &carregado.mapa;
+    int falhas = 0;
+    if (carregado.numJogadores != original.numJogadores || carregado.vencedor != original.vencedor) {
+        printf("  jogadores ou vencedor diferentes\n");
+        falhas++;
+    } else {
+        for (int i = 0; i < original.numJogadores; i++) {
+            const Jogador* x = &original.jogadores[i];
+            const Jogador* y = &carregado.jogadores[i];
+            if (strcmp(x->nome, y->nome) != 0 || x->cor != y->cor || x->venceu != y->venceu ||
+                memcmp(&x->missao, &y->missao, sizeof(Missao)) != 0) {
+                printf("  jogador %d diferente\n", i);
+                falhas++;
+            }
+        }
+    }
+    size_t n = (size_t)a->quantidade;
+    if (b->quantidade != a->quantidade || b->cores.total != a->cores.total ||
+        memcmp(b->cores.nomes, a->cores.nomes, sizeof(a->cores.nomes)) != 0) {
+        // Sem a mesma quantidade, as colunas não podem ser comparadas
+        printf("  quantidade de territórios ou cores diferente\n");
+        n = 0;
+        falhas++;
+    } else if (assinarMapa(b) != assinarMapa(a) || memcmp(b->corOriginal, a->corOriginal, n) != 0) {
+        printf("  colunas de dono, tropas ou cor original diferentes\n");
+        falhas++;
+    }
+    if (memcmp(&b->agregados, &a->agregados, sizeof(AgregadosMapa)) != 0 ||
+        memcmp(b->aliados, a->aliados, n * sizeof(int)) != 0) {
+        printf("  agregados ou aliados diferentes\n");
+        falhas++;
+    }
+    if ((a->vizinhos == NULL) != (b->vizinhos == NULL) ||
+        (a->vizinhos != NULL && 
+         (memcmp(b->inicioVizinhos, a->inicioVizinhos, (n + 1) * sizeof(int64_t)) != 0 ||
+          memcmp(b->vizinhos, a->vizinhos, (size_t)a->inicioVizinhos[n] * sizeof(int)) != 0))) {
+        printf("  grafo de fronteiras diferente\n");
+        falhas++;
+    }
+    for (int t = 0; t < (int)n; t++) {
+        if (strcmp(nomeTerritorio(a, t), nomeTerritorio(b, t)) != 0 || 
+            buscarTerritorio(b, nomeTerritorio(a, t)) != t) {
+            printf("  nome ou índice de nomes diferente no território %d\n", t);
+            falhas++;
+            break;
+        }
+    }
+    encerrarJogo(&original);
+    encerrarJogo(&carregado);
+    return falhas;
+}
 
-// Função para alocar memória dinamicamente para os territórios
-Territorio* alocarTeritorios(int quantidade) {
-    Territorio* mapa = (Territorio*)calloc(quantidade, sizeof(Territorio));
-    if (mapa == NULL) {
-        printf("Erro: Não foi possível alocar memória para os territórios!\n");
-        exit(1);
+// Função auxiliar para jogar TURNOS_VERIFICACAO turnos simultâneos de robôs em
+// uma partida sintética com 'numThreads' threads e assinar o mapa final.
+// Retorna 0 se faltou memória.
+static int assinarTurnosSimultaneos(uint64_t semente, int numThreads, uint64_t* assinatura) {
+    Arena arena;
+    if (!criarArena(&arena, (size_t)TERRITORIOS_VERIFICACAO * 256 + ((size_t)1 << 20))) return 0;
+    Jogo* jogo = criarJogoNaArena(&arena, semente);
+    if (jogo != NULL) jogo->mapa.partidaLog = 0;
+    if (jogo == NULL || !gerarJogoSintetico(jogo, TERRITORIOS_VERIFICACAO, 16, 16, 1)) {
+        destruirArena(&arena);
+        return 0;
     }
-    printf("Memória alocada com sucesso para %d territórios.\n", quantidade);
-    return mapa;
+    
+    ResolvedorTurno resolvedor;
+    RobosSimultaneos robos;
+    memset(&robos, 0, sizeof(robos));
+    int ok = criarResolvedorTurno(&resolvedor, &jogo->mapa, numThreads) && 
+             prepararRobosSimultaneos(&robos, &resolvedor, jogo);
+    if (ok) {
+        ResumoTurno totais = {0, 0, 0, 0};
+        long long enviadas = 0;
+        double tempoRobos = 0, tempoResolucao = 0;
+        jogarTurnosSimultaneos(jogo, &robos, TURNOS_VERIFICACAO, 0, semente, &totais, &enviadas, 
+                               &tempoRobos, &tempoResolucao);
+        *assinatura = assinarMapa(&jogo->mapa);
+    }
+    free(robos.ordens);
+    free(robos.ordensFatia);
+    liberarResolvedorTurno(&resolvedor);
+    destruirArena(&arena);
+    return ok;
 }
 
-// Função para alocar memória dinamicamente para os jogadores
-Jogador* alocarJogadores(int quantidade) {
-    Jogador* jogadores = (Jogador*)calloc(quantidade, sizeof(Jogador));
-    if (jogadores == NULL) {
-        printf("Erro: Não foi possível alocar memória para os jogadores!\n");
-        exit(1);
+// Verificação: os turnos simultâneos chegam à mesma assinatura do mapa com 1
+// thread e com 'numThreads'. Retorna o número de divergências.
+static int verificarTurnosSimultaneos(uint64_t semente, int numThreads) {
+    uint64_t umaThread = 0, variasThreads = 0;
+    if (!assinarTurnosSimultaneos(semente, 1, &umaThread) || 
+        !assinarTurnosSimultaneos(semente, numThreads, &variasThreads)) {
+        printf("  faltou memória para a partida de %d territórios\n", TERRITORIOS_VERIFICACAO);
+        return 1;
     }
-    printf("Memória alocada com sucesso para %d jogadores.\n", quantidade);
-    return jogadores;
+    if (umaThread != variasThreads) {
+        printf("  assinatura %016llx com 1 thread, %016llx com %d\n", (unsigned long long)umaThread, 
+               (unsigned long long)variasThreads, numThreads);
+        return 1;
+    }
+    return 0;
 }
 
-// Função para atribuir missão estratégica a um jogador
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
-    int indiceMissao = rand() % totalMissoes;
-    
-    // Alocar memória para a missão
-    destino = (char*)malloc(strlen(missoes[indiceMissao]) + 1);
-    if (destino == NULL) {
-        printf("Erro: Não foi possível alocar memória para a missão!\n");
-        exit(1);
+// Modo de linha de comando: war --verificar [threads] [--semente S]
+// Autoverificação: confere, com dados sorteados, propriedades que os modos
+// rápidos precisam manter (cada caso compara dois caminhos para o mesmo
+// resultado). Retorna 0 se tudo passou e 1 se algum caso divergiu.
+int executarModoVerificacao(int argc, char* argv[]) {
+    uint64_t semente = (uint64_t)time(NULL);
+    int numThreads = 8;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) semente = strtoull(argv[++i], NULL, 10);
+        else numThreads = atoi(argv[i]);
+    }
+    if (numThreads < 2 || numThreads > MAX_THREADS_SIMULACAO) {
+        printf("Uso: %s --verificar [threads] [--semente S]\n(de 2 a %d threads)\n", argv[0], MAX_THREADS_SIMULACAO);
+        return 1;
     }
     
-    // Copiar a missão sorteada
-    strcpy(destino, missoes[indiceMissao]);
+    printf("=== AUTOVERIFICAÇÃO (semente %llu, %d threads) ===\n", (unsigned long long)semente, numThreads);
+    const char* casos[] = {
+        "varredura: versões vetoriais iguais à escalar",
+        "vitória: auditoria pelas colunas igual aos agregados",
+        "chances exatas dentro da tolerância da simulação",
+        "diário: desfazer e refazer restauram a assinatura",
+        "snapshot: salvar e carregar devolve o mesmo estado",
+        "turnos simultâneos: mesma assinatura com 1 e N threads"
+    };
+    int totalCasos = (int)(sizeof(casos) / sizeof(casos[0]));
+    int aprovados = 0;
+    for (int caso = 0; caso < totalCasos; caso++) {
+        double inicio = tempoAtual();
+        int falhas;
+        printf("- %s\n", casos[caso]);
+        fflush(stdout);
+        switch (caso) {
+            case 0: falhas = verificarVersoesVarredura(semente); break;
+            case 1: falhas = verificarAuditoriaVitoria(semente); break;
+            case 2: falhas = verificarChances(semente, numThreads); break;
+            case 3: falhas = verificarDesfazerRefazer(semente); break;
+            case 4: falhas = verificarSnapshot(semente); break;
+            default: falhas = verificarTurnosSimultaneos(semente, numThreads); break;
+        }
+        printf("  %s (%.2f s)\n", falhas == 0 ? "ok" : "FALHOU", tempoAtual() - inicio);
+        aprovados += falhas == 0;
+    }
+    printf("\nResultado: %d de %d verificações passaram\n", aprovados, totalCasos);
+    return aprovados == totalCasos ? 0 : 1;
+}
+
+// Partida em andamento durante a leitura do log: só as que ainda não
+// terminaram ficam em memória, então o consumo não depende do tamanho do log
+typedef struct {
+    uint64_t partida;               // 0: posição livre
+    uint64_t rodadas;               // Rolagens vistas até agora
+    int8_t missoes[MAX_CORES];      // Última missão de cada jogador (-1: nenhuma)
+} PartidaAberta;
+
+// Estado da análise de um log (agregados de todas as partidas lidas)
+typedef struct {
+    PartidaAberta* abertas;         // Endereçamento aberto pela identificação da partida
+    uint32_t capacidade;            // Potência de 2
+    uint32_t ocupadas;
+    uint64_t eventos;
+    uint64_t invalidos;             // Registros de tipo desconhecido
+    uint64_t iniciadas;
+    uint64_t encerradas;
+    uint64_t semInicio;             // Fim de uma partida cujo início não estava nos arquivos lidos
+    uint64_t comVencedor;
+    uint64_t somaRodadas;           // Das partidas encerradas
+    uint64_t maiorPartida;
+    uint64_t rolagens;
+    uint64_t conquistas;
+    uint64_t blitz;
+    uint64_t sorteiosMissao[TOTAL_MISSOES];             // Por posição em missoesPredefinidas
+    uint64_t vitoriasMissao[TOTAL_MISSOES];
+    uint64_t* ataquesTerritorio;    // Mapa de calor por índice de território
+    uint64_t* conquistasTerritorio;
+    size_t territorios;             // Posições alocadas nos dois vetores acima
+} AnaliseLog;
+
+// Função auxiliar para espalhar a identificação de uma partida na tabela
+static inline uint32_t posicaoPartidaAberta(const AnaliseLog* analise, uint64_t partida) {
+    partida ^= partida >> 33;
+    partida *= 0xff51afd7ed558ccdULL;
+    partida ^= partida >> 33;
+    return (uint32_t)partida & (analise->capacidade - 1);
 }
 
-// Função corrigida para atribuir missão (passagem por referência)
-void atribuirMissaoCorreta(Jogador* jogador, char* missoes[], int totalMissoes) {
-    int indiceMissao = rand() % totalMissoes;
+// Função para buscar uma partida aberta; com 'criar', inclui se não existe.
+// Retorna NULL se a partida não está aberta (e 'criar' é 0).
+static PartidaAberta* buscarPartidaAberta(AnaliseLog* analise, uint64_t partida, int criar) {
+    if (criar && (analise->ocupadas + 1) * 4 > analise->capacidade * 3) {
+        // Dobrar a tabela e reinserir
+        PartidaAberta* antigas = analise->abertas;
+        uint32_t capacidadeAntiga = analise->capacidade;
+        analise->capacidade = capacidadeAntiga > 0 ? capacidadeAntiga * 2 : 64;
+        analise->abertas = (PartidaAberta*)calloc(analise->capacidade, sizeof(PartidaAberta));
+        if (analise->abertas == NULL) {
+            printf("Erro: Falha na alocação de memória para as partidas em andamento!\n");
+            exit(1);
+        }
+        for (uint32_t i = 0; i < capacidadeAntiga; i++) {
+            if (antigas[i].partida == 0) continue;
+            uint32_t p = posicaoPartidaAberta(analise, antigas[i].partida);
+            while (analise->abertas[p].partida != 0) p = (p + 1) & (analise->capacidade - 1);
+            analise->abertas[p] = antigas[i];
+        }
+        free(antigas);
+    }
+    if (analise->capacidade == 0) return NULL;
     
-    // Alocar memória para a missão
-    jogador->missao = (char*)malloc(strlen(missoes[indiceMissao]) + 1);
-    if (jogador->missao == NULL) {
-        printf("Erro: Não foi possível alocar memória para a missão!\n");
-        exit(1);
+    uint32_t p = posicaoPartidaAberta(analise, partida);
+    while (analise->abertas[p].partida != 0) {
+        if (analise->abertas[p].partida == partida) return &analise->abertas[p];
+        p = (p + 1) & (analise->capacidade - 1);
     }
+    if (!criar) return NULL;
     
-    // Copiar a missão sorteada
-    strcpy(jogador->missao, missoes[indiceMissao]);
-    jogador->venceu = 0; // Inicializar como não venceu
+    PartidaAberta* aberta = &analise->abertas[p];
+    memset(aberta, 0, sizeof(PartidaAberta));
+    memset(aberta->missoes, -1, sizeof(aberta->missoes));
+    aberta->partida = partida;
+    analise->ocupadas++;
+    return aberta;
 }
 
-// Função para exibir a missão de um jogador (passagem por valor)
-void exibirMissao(char* missao, char* nomeJogador) {
-    printf("\n🎯 MISSÃO ESTRATÉGICA DE %s:\n", nomeJogador);
-    printf("   \"%s\"\n", missao);
-    printf("   Complete esta missão para vencer o jogo!\n");
+// Função para tirar uma partida da tabela, puxando para trás as entradas
+// seguintes do mesmo agrupamento (sondagem linear sem marcas de remoção)
+static void removerPartidaAberta(AnaliseLog* analise, PartidaAberta* aberta) {
+    uint32_t mascara = analise->capacidade - 1;
+    uint32_t livre = (uint32_t)(aberta - analise->abertas);
+    uint32_t p = livre;
+    for (;;) {
+        p = (p + 1) & mascara;
+        if (analise->abertas[p].partida == 0) break;
+        uint32_t ideal = posicaoPartidaAberta(analise, analise->abertas[p].partida);
+        // A entrada em p pode ocupar 'livre' se 'livre' está entre a posição ideal e p
+        if (((p - ideal) & mascara) >= ((p - livre) & mascara)) {
+            analise->abertas[livre] = analise->abertas[p];
+            livre = p;
+        }
+    }
+    analise->abertas[livre].partida = 0;
+    analise->ocupadas--;
 }
 
-// Função para verificar se uma missão foi cumprida
-int verificarMissao(char* missao, Territorio* mapa, int tamanho, char* corJogador) {
-    // Missão 1: Conquistar 3 territórios consecutivos da mesma cor
-    if (strstr(missao, "3 territorios consecutivos") != NULL) {
-        int consecutivos = 0;
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                consecutivos++;
-                if (consecutivos >= 3) return 1;
-            } else {
-                consecutivos = 0;
-            }
+// Função para contar um ataque ou uma conquista no mapa de calor
+static void contarTerritorioAnalise(AnaliseLog* analise, int32_t territorio, int conquistou) {
+    if (territorio < 0) return;
+    if ((size_t)territorio >= analise->territorios) {
+        size_t novo = analise->territorios > 0 ? analise->territorios : 1024;
+        while (novo <= (size_t)territorio) novo *= 2;
+        uint64_t* ataques = (uint64_t*)realloc(analise->ataquesTerritorio, novo * sizeof(uint64_t));
+        uint64_t* conquistas = ataques != NULL 
+                               ? (uint64_t*)realloc(analise->conquistasTerritorio, novo * sizeof(uint64_t)) : NULL;
+        if (conquistas == NULL) {
+            printf("Erro: Falha na alocação de memória para o mapa de calor!\n");
+            exit(1);
         }
+        memset(ataques + analise->territorios, 0, (novo - analise->territorios) * sizeof(uint64_t));
+        memset(conquistas + analise->territorios, 0, (novo - analise->territorios) * sizeof(uint64_t));
+        analise->ataquesTerritorio = ataques;
+        analise->conquistasTerritorio = conquistas;
+        analise->territorios = novo;
+    }
+    analise->ataquesTerritorio[territorio]++;
+    analise->conquistasTerritorio[territorio] += conquistou != 0;
+}
+
+// Função para incorporar um registro do log à análise
+static void analisarEvento(AnaliseLog* analise, const EventoLog* evento, PartidaAberta** ultima) {
+    PartidaAberta* aberta = *ultima;
+    analise->eventos++;
+    
+    // Registros seguidos costumam ser da mesma partida: evita a busca na tabela
+    if (aberta == NULL || aberta->partida != evento->partida) {
+        aberta = buscarPartidaAberta(analise, evento->partida, evento->tipo == EVENTO_PARTIDA);
     }
     
-    // Missão 2: Eliminar todas as tropas de cor vermelha
-    else if (strstr(missao, "cor vermelha") != NULL) {
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, "Vermelho") == 0 || strcmp(mapa[i].cor, "vermelho") == 0) {
-                return 0; // Ainda existem territórios vermelhos
+    switch (evento->tipo) {
+        case EVENTO_PARTIDA:
+            analise->iniciadas++;
+            break;
+        case EVENTO_TERRITORIO:
+            break;
+        case EVENTO_MISSAO:
+            if (aberta != NULL && evento->origem >= 0 && evento->origem < MAX_CORES && 
+                evento->destino >= 0 && evento->destino < TOTAL_MISSOES) {
+                aberta->missoes[evento->origem] = (int8_t)evento->destino;
+            }
+            break;
+        case EVENTO_ATAQUE:
+        case EVENTO_BLITZ: {
+            uint32_t rodadas = evento->tipo == EVENTO_BLITZ ? evento->extra : 1;
+            analise->rolagens += rodadas;
+            analise->blitz += evento->tipo == EVENTO_BLITZ;
+            analise->conquistas += evento->conquistou != 0;
+            if (aberta != NULL) aberta->rodadas += rodadas;
+            contarTerritorioAnalise(analise, evento->destino, evento->conquistou);
+            break;
+        }
+        case EVENTO_FIM: {
+            if (aberta == NULL) {
+                analise->semInicio++;
+                break;
             }
+            uint64_t rodadas = aberta->rodadas > evento->extra ? aberta->rodadas : evento->extra;
+            analise->encerradas++;
+            analise->somaRodadas += rodadas;
+            if (rodadas > analise->maiorPartida) analise->maiorPartida = rodadas;
+            analise->comVencedor += evento->origem >= 0;
+            for (int j = 0; j < MAX_CORES; j++) {
+                if (aberta->missoes[j] < 0) continue;
+                analise->sorteiosMissao[aberta->missoes[j]]++;
+                analise->vitoriasMissao[aberta->missoes[j]] += j == evento->origem;
+            }
+            removerPartidaAberta(analise, aberta);
+            aberta = NULL;
+            break;
         }
-        return 1; // Não há mais territórios vermelhos
+        default:
+            analise->invalidos++;
     }
+    *ultima = aberta;
+}
+
+// Função para ler um arquivo do log em blocos, sem carregá-lo inteiro: a
+// memória usada é a do bloco mais as partidas em andamento.
+// Retorna o número de bytes lidos ou -1 se o arquivo não é um log válido.
+static long long analisarArquivoLog(AnaliseLog* analise, const char* caminho) {
+    static char bloco[1 << 22];
+    CabecalhoLog cabecalho;
+    PartidaAberta* ultima = NULL;
     
-    // Missão 3: Controlar pelo menos 5 territórios
-    else if (strstr(missao, "5 territorios") != NULL) {
-        int territoriosControlados = 0;
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                territoriosControlados++;
-            }
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) return -1;
+    if (read(descritor, &cabecalho, sizeof(cabecalho)) != (ssize_t)sizeof(cabecalho) || 
+        memcmp(cabecalho.magico, MAGICO_LOG, sizeof(MAGICO_LOG)) != 0 || 
+        cabecalho.versao != VERSAO_LOG || cabecalho.tamanhoEvento != sizeof(EventoLog) || 
+        cabecalho.marcaEndian != MARCA_ENDIAN_LOG) {
+        close(descritor);
+        return -1;
+    }
+    posix_fadvise(descritor, 0, 0, POSIX_FADV_SEQUENTIAL);
+    
+    long long lidos = sizeof(cabecalho);
+    size_t pendente = 0; // Bytes de um registro cortado no fim do bloco anterior
+    for (;;) {
+        ssize_t quantidade = read(descritor, bloco + pendente, sizeof(bloco) - pendente);
+        if (quantidade < 0 && errno == EINTR) continue;
+        if (quantidade <= 0) break;
+        
+        size_t disponivel = pendente + (size_t)quantidade;
+        size_t completos = disponivel / sizeof(EventoLog);
+        const EventoLog* eventos = (const EventoLog*)bloco;
+        for (size_t i = 0; i < completos; i++) {
+            analisarEvento(analise, &eventos[i], &ultima);
         }
-        return territoriosControlados >= 5;
+        pendente = disponivel - completos * sizeof(EventoLog);
+        memmove(bloco, bloco + completos * sizeof(EventoLog), pendente);
+        
+        // O que já foi lido não precisa ficar no cache de páginas
+        posix_fadvise(descritor, 0, lidos, POSIX_FADV_DONTNEED);
+        lidos += quantidade;
+    }
+    if (pendente > 0) {
+        fprintf(stderr, "Aviso: '%s' termina com um registro incompleto (%zu bytes ignorados).\n", 
+                caminho, pendente);
+    }
+    close(descritor);
+    return lidos;
+}
+
+// Modo de linha de comando: war --analisar-log <arquivo.wlog>... [--mapa-calor arquivo.csv] [--top N]
+// Lê os arquivos em sequência, em blocos, e imprime taxa de vitória por
+// missão, duração das partidas e os territórios mais conquistados.
+int executarModoAnaliseLog(int argc, char* argv[]) {
+    const char* caminhoCalor = NULL;
+    int top = 10, arquivos = 0;
+    long long bytes = 0;
+    AnaliseLog* analise = (AnaliseLog*)calloc(1, sizeof(AnaliseLog));
+    if (analise == NULL) {
+        printf("Erro: Falha na alocação de memória para a análise!\n");
+        exit(1);
     }
     
-    // Missão 4: Acumular mais de 15 tropas em um único território
-    else if (strstr(missao, "15 tropas") != NULL) {
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0 && mapa[i].tropas > 15) {
+    double inicio = tempoAtual();
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--mapa-calor") == 0 && i + 1 < argc) {
+            caminhoCalor = argv[++i];
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+        } else {
+            long long lidos = analisarArquivoLog(analise, argv[i]);
+            if (lidos < 0) {
+                fprintf(stderr, "Erro: '%s' não é um log de eventos válido!\n", argv[i]);
+                free(analise);
                 return 1;
             }
+            bytes += lidos;
+            arquivos++;
         }
     }
+    if (arquivos == 0) {
+        printf("Uso: %s --analisar-log <arquivo.wlog>... [--mapa-calor arquivo.csv] [--top N]\n", argv[0]);
+        free(analise);
+        return 1;
+    }
+    double duracao = tempoAtual() - inicio;
     
-    // Missão 5: Conquistar territórios de pelo menos 3 cores diferentes
-    else if (strstr(missao, "3 cores diferentes") != NULL) {
-        char coresConquistadas[10][10];
-        int totalCores = 0;
-        
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                // Verificar se já conquistou território dessa cor original
-                int jaContada = 0;
-                for (int j = 0; j < totalCores; j++) {
-                    if (strcmp(coresConquistadas[j], mapa[i].cor) == 0) {
-                        jaContada = 1;
-                        break;
-                    }
-                }
-                if (!jaContada && totalCores < 10) {
-                    strcpy(coresConquistadas[totalCores], mapa[i].cor);
-                    totalCores++;
-                }
-            }
-        }
-        return totalCores >= 3;
+    printf("=== ANÁLISE DO LOG DE EVENTOS ===\n");
+    printf("Arquivos: %d | Eventos: %llu (%.1f MB) em %.2f s (%.0f MB/s)\n", arquivos, 
+           (unsigned long long)analise->eventos, bytes / 1e6, duracao, duracao > 0 ? bytes / 1e6 / duracao : 0);
+    if (analise->invalidos > 0) {
+        printf("Registros de tipo desconhecido: %llu\n", (unsigned long long)analise->invalidos);
+    }
+    printf("Partidas: %llu iniciadas, %llu encerradas (%llu com vencedor), %u sem fim (interrompidas ou com erro)", 
+           (unsigned long long)analise->iniciadas, (unsigned long long)analise->encerradas, 
+           (unsigned long long)analise->comVencedor, analise->ocupadas);
+    if (analise->semInicio > 0) printf(", %llu sem início nos arquivos", (unsigned long long)analise->semInicio);
+    printf("\n");
+    if (analise->encerradas > 0) {
+        printf("Duração: %.1f rolagens por partida em média (maior: %llu)\n", 
+               (double)analise->somaRodadas / analise->encerradas, (unsigned long long)analise->maiorPartida);
     }
+    printf("Rolagens: %llu | Conquistas: %llu (%.2f%%) | Ataques relâmpago: %llu\n", 
+           (unsigned long long)analise->rolagens, (unsigned long long)analise->conquistas, 
+           analise->rolagens > 0 ? 100.0 * analise->conquistas / analise->rolagens : 0.0, 
+           (unsigned long long)analise->blitz);
     
-    // Missão 6: Ser o jogador com maior número total de tropas
-    else if (strstr(missao, "maior numero total") != NULL) {
-        int tropasJogador = 0;
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                tropasJogador += mapa[i].tropas;
+    printf("\nVitórias por missão (partidas encerradas):\n");
+    for (int k = 0; k < TOTAL_MISSOES; k++) {
+        const DefinicaoMissao* definicao = &missoesPredefinidas[k];
+        Missao missao = {definicao->tipo, definicao->parametro, k, -1, -1};
+        char texto[128];
+        descreverMissao(&missao, texto, sizeof(texto));
+        uint64_t sorteios = analise->sorteiosMissao[k], vitorias = analise->vitoriasMissao[k];
+        printf("%d. %-60s %10llu / %-10llu %6.2f%%\n", k + 1, texto, (unsigned long long)vitorias, 
+               (unsigned long long)sorteios, sorteios > 0 ? 100.0 * vitorias / sorteios : 0.0);
+    }
+    
+    // Territórios mais conquistados: seleção dos 'top' maiores em uma passada
+    if (top > 0 && analise->territorios > 0) {
+        int* melhores = (int*)malloc((size_t)top * sizeof(int));
+        int total = 0;
+        if (melhores == NULL) {
+            printf("Erro: Falha na alocação de memória para o ranking!\n");
+            exit(1);
+        }
+        for (size_t t = 0; t < analise->territorios; t++) {
+            uint64_t conquistas = analise->conquistasTerritorio[t];
+            if (conquistas == 0) continue;
+            if (total == top && conquistas <= analise->conquistasTerritorio[melhores[total - 1]]) continue;
+            int p = total < top ? total++ : total - 1;
+            while (p > 0 && analise->conquistasTerritorio[melhores[p - 1]] < conquistas) {
+                melhores[p] = melhores[p - 1];
+                p--;
             }
+            melhores[p] = (int)t;
+        }
+        printf("\nTerritórios mais conquistados (posição: conquistas / ataques sofridos):\n");
+        for (int i = 0; i < total; i++) {
+            int t = melhores[i];
+            printf("- %d: %llu / %llu\n", t + 1, (unsigned long long)analise->conquistasTerritorio[t], 
+                   (unsigned long long)analise->ataquesTerritorio[t]);
         }
-        // Implementação simplificada - retorna verdadeiro se tem mais de 20 tropas
-        return tropasJogador > 20;
+        free(melhores);
     }
     
-    // Missão 7: Conquistar território chamado 'Capital'
-    else if (strstr(missao, "Capital") != NULL) {
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].nome, "Capital") == 0 && strcmp(mapa[i].cor, corJogador) == 0) {
-                return 1;
+    int ok = 1;
+    if (caminhoCalor != NULL) {
+        FILE* arquivo = fopen(caminhoCalor, "w");
+        if (arquivo == NULL) {
+            ok = 0;
+        } else {
+            fprintf(arquivo, "territorio,ataques,conquistas\n");
+            for (size_t t = 0; t < analise->territorios; t++) {
+                if (analise->ataquesTerritorio[t] == 0) continue;
+                fprintf(arquivo, "%zu,%llu,%llu\n", t + 1, (unsigned long long)analise->ataquesTerritorio[t], 
+                        (unsigned long long)analise->conquistasTerritorio[t]);
             }
+            ok = fclose(arquivo) == 0;
         }
+        if (!ok) fprintf(stderr, "Erro: Não foi possível escrever o mapa de calor em '%s'!\n", caminhoCalor);
     }
     
-    return 0; // Missão não cumprida
+    free(analise->abertas);
+    free(analise->ataquesTerritorio);
+    free(analise->conquistasTerritorio);
+    free(analise);
+    return ok ? 0 : 1;
 }
 
-// Função para verificar se algum jogador venceu
-int verificarVencedor(Jogador* jogadores, int numJogadores, Territorio* mapa, int tamanhoMapa) {
-    for (int i = 0; i < numJogadores; i++) {
-        if (!jogadores[i].venceu) {
-            if (verificarMissao(jogadores[i].missao, mapa, tamanhoMapa, jogadores[i].cor)) {
-                jogadores[i].venceu = 1;
-                printf("\n🏆 TEMOS UM VENCEDOR! 🏆\n");
-                printf("Jogador %s (%s) completou sua missão!\n", 
-                       jogadores[i].nome, jogadores[i].cor);
-                printf("Missão: \"%s\"\n", jogadores[i].missao);
-                return i; // Retorna índice do vencedor
+#ifndef WAR_SEM_METRICAS
+// Soma das métricas de todas as threads, no momento da exportação
+typedef struct {
+    uint64_t contadores[TOTAL_CONTADORES];
+    uint64_t baldes[TOTAL_LATENCIAS][BALDES_LATENCIA];
+    uint64_t somaNs[TOTAL_LATENCIAS];
+    uint64_t amostras[TOTAL_LATENCIAS];
+    int threads;
+} TotaisMetricas;
+
+// Função para somar as métricas de todas as threads (chamada com travaMetricas)
+static void somarMetricasThreads(TotaisMetricas* totais) {
+    memset(totais, 0, sizeof(TotaisMetricas));
+    for (MetricasThread* m = listaMetricas; m != NULL; m = m->proxima) {
+        totais->threads++;
+        for (int c = 0; c < TOTAL_CONTADORES; c++) {
+            totais->contadores[c] += atomic_load_explicit(&m->contadores[c], memory_order_relaxed);
+        }
+        for (int l = 0; l < TOTAL_LATENCIAS; l++) {
+            totais->somaNs[l] += atomic_load_explicit(&m->somaNs[l], memory_order_relaxed);
+            for (int b = 0; b < BALDES_LATENCIA; b++) {
+                uint64_t valor = atomic_load_explicit(&m->baldes[l][b], memory_order_relaxed);
+                totais->baldes[l][b] += valor;
+                totais->amostras[l] += valor;
             }
         }
     }
-    return -1; // Nenhum vencedor ainda
 }
 
-// Função para liberar a memória alocada dinamicamente
-void liberarMemoria(Territorio* mapa, Jogador* jogadores, int numJogadores) {
-    // Liberar memória dos territórios
-    if (mapa != NULL) {
-        free(mapa);
-        printf("Memória dos territórios liberada com sucesso.\n");
+// Função para escrever as métricas em JSON (baldes[b] conta durações < 2^b ns)
+static void escreverMetricasJson(FILE* arquivo, const TotaisMetricas* totais) {
+    fprintf(arquivo, "{\"threads\":%d,\"contadores\":{", totais->threads);
+    for (int c = 0; c < TOTAL_CONTADORES; c++) {
+        fprintf(arquivo, "%s\"%s\":%llu", c > 0 ? "," : "", nomesContadores[c], 
+                (unsigned long long)totais->contadores[c]);
     }
-    
-    // Liberar memória das missões dos jogadores
-    if (jogadores != NULL) {
-        for (int i = 0; i < numJogadores; i++) {
-            if (jogadores[i].missao != NULL) {
-                free(jogadores[i].missao);
-            }
+    fprintf(arquivo, "},\"latencias_ns\":{");
+    for (int l = 0; l < TOTAL_LATENCIAS; l++) {
+        int ultimo = BALDES_LATENCIA - 1;
+        while (ultimo > 0 && totais->baldes[l][ultimo] == 0) ultimo--;
+        fprintf(arquivo, "%s\"%s\":{\"amostragem\":%u,\"amostras\":%llu,\"soma\":%llu,\"baldes\":[", 
+                l > 0 ? "," : "", nomesLatencias[l], amostragemLatencias[l],
+                (unsigned long long)totais->amostras[l], (unsigned long long)totais->somaNs[l]);
+        for (int b = 0; b <= ultimo; b++) {
+            fprintf(arquivo, "%s%llu", b > 0 ? "," : "", (unsigned long long)totais->baldes[l][b]);
         }
-        free(jogadores);
+        fprintf(arquivo, "]}");
     }
+    fprintf(arquivo, "}}\n");
 }
 
-// Função para cadastrar um jogador
-void cadastrarJogador(Jogador* jogador, int indice) {
-    printf("\n=== CADASTRO DO JOGADOR %d ===\n", indice + 1);
-    
-    printf("Digite o nome do jogador: ");
-    scanf(" %19s", jogador->nome);
-    
-    printf("Digite a cor do exército: ");
-    scanf(" %9s", jogador->cor);
-    
-    // Atribuir missão estratégica
-    atribuirMissaoCorreta(jogador, missoesPredefinidas, TOTAL_MISSOES);
-    
-    printf("Jogador '%s' cadastrado com sucesso!\n", jogador->nome);
-    exibirMissao(jogador->missao, jogador->nome);
-}
-
-// Função para cadastrar um território usando ponteiros
-void cadastrarTerritorio(Territorio* territorio, int indice) {
-    printf("\n=== CADASTRO DO TERRITÓRIO %d ===\n", indice + 1);
-    
-    // Entrada do nome do território
-    printf("Digite o nome do território: ");
-    scanf(" %29s", territorio->nome);  // Uso de ponteiro para acessar o campo
-    
-    // Entrada da cor do exército
-    printf("Digite a cor do exército: ");
-    scanf(" %9s", territorio->cor);    // Uso de ponteiro para acessar o campo
-    
-    // Entrada da quantidade de tropas (mínimo 1 para poder atacar)
-    do {
-        printf("Digite o número de tropas (mínimo 1): ");
-        scanf("%d", &territorio->tropas);
-        if (territorio->tropas < 1) {
-            printf("Erro: Um território deve ter pelo menos 1 tropa!\n");
+// Função para escrever as métricas no formato texto do Prometheus
+static void escreverMetricasPrometheus(FILE* arquivo, const TotaisMetricas* totais) {
+    fprintf(arquivo, "# TYPE war_threads gauge\nwar_threads %d\n", totais->threads);
+    for (int c = 0; c < TOTAL_CONTADORES; c++) {
+        fprintf(arquivo, "# TYPE war_%s_total counter\nwar_%s_total %llu\n", nomesContadores[c], 
+                nomesContadores[c], (unsigned long long)totais->contadores[c]);
+    }
+    for (int l = 0; l < TOTAL_LATENCIAS; l++) {
+        uint64_t acumulado = 0;
+        fprintf(arquivo, "# TYPE war_latencia_%s_ns histogram\n", nomesLatencias[l]);
+        for (int b = 0; b < BALDES_LATENCIA - 1; b++) {
+            acumulado += totais->baldes[l][b];
+            fprintf(arquivo, "war_latencia_%s_ns_bucket{le=\"%llu\"} %llu\n", nomesLatencias[l], 
+                    (unsigned long long)((1ULL << b) - 1), (unsigned long long)acumulado);
         }
-    } while (territorio->tropas < 1);
-    
-    printf("Território '%s' cadastrado com sucesso!\n", territorio->nome);
-}
-
-// Função para exibir os dados de um território usando ponteiros
-void exibirTerritorio(Territorio* territorio, int indice) {
-    printf("Território %d:\n", indice + 1);
-    printf("  Nome: %s\n", territorio->nome);
-    printf("  Cor do Exército: %s\n", territorio->cor);
-    printf("  Tropas: %d\n", territorio->tropas);
-    printf("  ---------------------------\n");
-}
-
-// Função para exibir todos os territórios cadastrados
-void exibirTodosTeritorios(Territorio* territorios, int quantidade) {
-    printf("\n=== MAPA DE TERRITÓRIOS ===\n");
-    printf("Total de territórios: %d\n\n", quantidade);
-    
-    for (int i = 0; i < quantidade; i++) {
-        exibirTerritorio(&territorios[i], i);
+        fprintf(arquivo, "war_latencia_%s_ns_bucket{le=\"+Inf\"} %llu\n", nomesLatencias[l], 
+                (unsigned long long)totais->amostras[l]);
+        fprintf(arquivo, "war_latencia_%s_ns_sum %llu\n", nomesLatencias[l], 
+                (unsigned long long)totais->somaNs[l]);
+        fprintf(arquivo, "war_latencia_%s_ns_count %llu\n", nomesLatencias[l], 
+                (unsigned long long)totais->amostras[l]);
     }
 }
 
-// Função para simular rolagem de dados (1 a 6)
-int rolarDado() {
-    return (rand() % 6) + 1;
-}
-
-// Função principal de ataque entre territórios
-void atacar(Territorio* atacante, Territorio* defensor) {
-    printf("\n=== SIMULAÇÃO DE BATALHA ===\n");
-    printf("Atacante: %s (%s) com %d tropas\n", 
-           atacante->nome, atacante->cor, atacante->tropas);
-    printf("Defensor: %s (%s) com %d tropas\n", 
-           defensor->nome, defensor->cor, defensor->tropas);
-    
-    // Simular rolagem de dados
-    int dadoAtacante = rolarDado();
-    int dadoDefensor = rolarDado();
-    
-    printf("\nRolagem de dados:\n");
-    printf("Atacante (%s): %d\n", atacante->cor, dadoAtacante);
-    printf("Defensor (%s): %d\n", defensor->cor, dadoDefensor);
+// Função para exportar as métricas para o arquivo de WAR_METRICAS: formato
+// Prometheus se o nome termina em ".prom", JSON nos demais casos. O arquivo é
+// escrito ao lado e renomeado, então quem lê nunca vê uma exportação pela metade.
+void exportarMetricas(void) {
+    char temporario[4096];
+    TotaisMetricas totais;
+    size_t tamanho = strlen(caminhoMetricas);
+    int prometheus = tamanho >= 5 && strcmp(caminhoMetricas + tamanho - 5, ".prom") == 0;
     
-    // Determinar resultado da batalha
-    if (dadoAtacante > dadoDefensor) {
-        printf("\n🎯 VITÓRIA DO ATACANTE!\n");
-        printf("O território '%s' foi conquistado por %s!\n", 
-               defensor->nome, atacante->cor);
-        
-        // Transferir controle do território
-        strcpy(defensor->cor, atacante->cor);
-        
-        // Transferir metade das tropas do atacante (mínimo 1)
-        int tropasTransferidas = (atacante->tropas / 2) > 0 ? (atacante->tropas / 2) : 1;
-        defensor->tropas = tropasTransferidas;
-        atacante->tropas -= tropasTransferidas;
-        
-        printf("Tropas transferidas: %d\n", tropasTransferidas);
+    pthread_mutex_lock(&travaMetricas);
+    somarMetricasThreads(&totais);
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminhoMetricas);
+    FILE* arquivo = fopen(temporario, "w");
+    if (arquivo == NULL) {
+        fprintf(stderr, "Erro: Não foi possível escrever as métricas em '%s'!\n", temporario);
     } else {
-        printf("\n🛡️ DEFESA BEM-SUCEDIDA!\n");
-        printf("O território '%s' resistiu ao ataque!\n", defensor->nome);
-        
-        // Atacante perde uma tropa
-        if (atacante->tropas > 1) {
-            atacante->tropas--;
-            printf("O atacante perdeu 1 tropa na batalha.\n");
+        if (prometheus) {
+            escreverMetricasPrometheus(arquivo, &totais);
         } else {
-            printf("O atacante não pode perder mais tropas (mínimo 1).\n");
+            escreverMetricasJson(arquivo, &totais);
+        }
+        if (fclose(arquivo) != 0 || rename(temporario, caminhoMetricas) != 0) {
+            fprintf(stderr, "Erro: Não foi possível escrever as métricas em '%s'!\n", caminhoMetricas);
         }
     }
-    
-    printf("\nResultado pós-batalha:\n");
-    printf("- %s (%s): %d tropas\n", 
-           atacante->nome, atacante->cor, atacante->tropas);
-    printf("- %s (%s): %d tropas\n", 
-           defensor->nome, defensor->cor, defensor->tropas);
+    pthread_mutex_unlock(&travaMetricas);
 }
 
-// Função para validar se um ataque é válido
-int validarAtaque(Territorio* atacante, Territorio* defensor) {
-    // Verificar se são territórios diferentes
-    if (strcmp(atacante->nome, defensor->nome) == 0) {
-        printf("Erro: Um território não pode atacar a si mesmo!\n");
-        return 0;
+// Thread que exporta as métricas a cada SIGUSR1. O sinal fica bloqueado em
+// todas as threads e é recebido aqui com sigwait, fora de um tratador de
+// sinal, então a exportação pode usar stdio normalmente.
+static void* aguardarSinalMetricas(void* argumento) {
+    sigset_t* sinais = (sigset_t*)argumento;
+    int sinal;
+    while (sigwait(sinais, &sinal) == 0) {
+        exportarMetricas();
     }
+    return NULL;
+}
+
+// Função para ativar as métricas se WAR_METRICAS indicar um arquivo: exporta
+// na saída do programa e a cada SIGUSR1 (kill -USR1 <pid>)
+void iniciarMetricas(void) {
+    static sigset_t sinais;
+    const char* caminho = getenv("WAR_METRICAS");
+    if (caminho == NULL || caminho[0] == '\0') return;
     
-    // Verificar se o atacante tem tropas suficientes
-    if (atacante->tropas < 2) {
-        printf("Erro: O território atacante deve ter pelo menos 2 tropas para atacar!\n");
-        return 0;
-    }
+    caminhoMetricas = caminho;
+    metricasAtivas = 1;
+    atexit(exportarMetricas);
     
-    // Verificar se não é um ataque da mesma cor (aliados)
-    if (strcmp(atacante->cor, defensor->cor) == 0) {
-        printf("Erro: Territórios da mesma cor não podem se atacar!\n");
-        return 0;
+    // Bloqueado antes de criar qualquer thread, para que todas herdem a máscara
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &sinais, NULL);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, aguardarSinalMetricas, &sinais) == 0) {
+        pthread_detach(thread);
     }
-    
-    return 1; // Ataque válido
 }
+#endif
 
-// Função para selecionar territórios para batalha
-void selecionarEAtacar(Territorio* territorios, int quantidade) {
-    int indiceAtacante, indiceDefensor;
+// Função para ativar o log de eventos se WAR_LOG indicar um prefixo: os
+// arquivos são <prefixo>.NNNNNN.wlog, girados a cada WAR_LOG_MB megabytes
+void iniciarLog(void) {
+    const char* prefixo = getenv("WAR_LOG");
+    const char* limite = getenv("WAR_LOG_MB");
+    if (prefixo == NULL || prefixo[0] == '\0') return;
     
-    printf("\n=== SELEÇÃO DE TERRITÓRIOS PARA BATALHA ===\n");
+    long long megabytes = limite != NULL ? atoll(limite) : 0;
+    if (megabytes < 1) megabytes = TAMANHO_PADRAO_ARQUIVO_LOG;
+    struct timespec agora;
+    clock_gettime(CLOCK_REALTIME, &agora);
+    uint64_t estado = (uint64_t)agora.tv_sec * 1000000000u + (uint64_t)agora.tv_nsec + ((uint64_t)getpid() << 40);
     
-    // Exibir territórios disponíveis
-    exibirTodosTeritorios(territorios, quantidade);
+    // Execuções diferentes têm identificadores diferentes: as partidas de
+    // vários logs podem ser analisadas juntas
+    execucaoLog = splitmix64(&estado) >> 32;
+    if (execucaoLog == 0) execucaoLog = 1;
+    prefixoLog = prefixo;
+    limiteArquivoLog = (uint64_t)megabytes << 20;
+    logAtivo = 1;
+    atexit(encerrarLog);
+}
+
+int main(int argc, char* argv[]) {
+#ifndef WAR_SEM_METRICAS
+    iniciarMetricas();
+#endif
+    iniciarLog();
     
-    // Selecionar território atacante
-    do {
-        printf("\nEscolha o território ATACANTE (1 a %d): ", quantidade);
-        scanf("%d", &indiceAtacante);
-        indiceAtacante--; // Converter para índice base 0
-        
-        if (indiceAtacante < 0 || indiceAtacante >= quantidade) {
-            printf("Erro: Índice inválido! Escolha entre 1 e %d.\n", quantidade);
-        } else if (territorios[indiceAtacante].tropas < 2) {
-            printf("Erro: O território '%s' não tem tropas suficientes para atacar!\n", 
-                   territorios[indiceAtacante].nome);
-            indiceAtacante = -1; // Forçar nova seleção
-        }
-    } while (indiceAtacante < 0 || indiceAtacante >= quantidade);
+    // Modos não interativos
+    if (argc > 1 && strcmp(argv[1], "--simular") == 0) {
+        return executarModoSimulacao(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--lote") == 0) {
+        return executarModoLote(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return executarModoBenchmark(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--odds") == 0) {
+        return executarModoChances(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--torneio") == 0) {
+        return executarModoTorneio(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--simultaneo") == 0) {
+        return executarModoSimultaneo(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--analisar-log") == 0) {
+        return executarModoAnaliseLog(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--servidor") == 0) {
+        return executarModoServidor(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--verificar") == 0) {
+        return executarModoVerificacao(argc, argv);
+    }
     
-    // Selecionar território defensor
-    do {
-        printf("Escolha o território DEFENSOR (1 a %d): ", quantidade);
-        scanf("%d", &indiceDefensor);
-        indiceDefensor--; // Converter para índice base 0
-        
-        if (indiceDefensor < 0 || indiceDefensor >= quantidade) {
-            printf("Erro: Índice inválido! Escolha entre 1 e %d.\n", quantidade);
+    // Inicializar gerador de números aleatórios (war --semente N repete uma partida)
+    // e, opcionalmente, retomar um jogo salvo (war --carregar arquivo)
+    uint64_t semente = (uint64_t)time(NULL);
+    const char* arquivoCarregado = NULL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--semente") == 0) {
+            semente = strtoull(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--carregar") == 0) {
+            arquivoCarregado = argv[i + 1];
         }
-    } while (indiceDefensor < 0 || indiceDefensor >= quantidade);
-    
-    // Validar e executar o ataque
-    if (validarAtaque(&territorios[indiceAtacante], &territorios[indiceDefensor])) {
-        atacar(&territorios[indiceAtacante], &territorios[indiceDefensor]);
     }
-}
-
-int main() {
-    // Inicializar gerador de números aleatórios
-    srand(time(NULL));
+    // A partida inteira (jogo, jogadores e colunas do mapa) fica em uma arena
+    Arena arena;
+    if (!criarArena(&arena, TAMANHO_ARENA_PADRAO)) {
+        printf("Erro: Não foi possível reservar memória para o jogo!\n");
+        exit(1);
+    }
+    Jogo* jogo = criarJogoNaArena(&arena, semente);
     
-    int quantidadeTeritorios, numJogadores;
-    Territorio* mapa = NULL;
-    Jogador* jogadores = NULL;
     int opcao, vencedor = -1;
     
     printf("=== WAR ESTRUTURADO - NÍVEL MESTRE ===\n");
-    printf("Sistema Completo com Missões Estratégicas\n\n");
-    
-    // Solicitar número de jogadores
-    do {
-        printf("Quantos jogadores irão participar? (2-4): ");
-        scanf("%d", &numJogadores);
-        if (numJogadores < 2 || numJogadores > 4) {
-            printf("Erro: O jogo deve ter entre 2 e 4 jogadores!\n");
-        }
-    } while (numJogadores < 2 || numJogadores > 4);
-    
-    // Alocar memória para jogadores
-    jogadores = alocarJogadores(numJogadores);
-    
-    // Cadastrar jogadores
-    printf("\n=== FASE DE CADASTRO DOS JOGADORES ===\n");
-    for (int i = 0; i < numJogadores; i++) {
-        cadastrarJogador(&jogadores[i], i);
+    printf("Sistema Completo com Missões Estratégicas\n");
+    if (arquivoCarregado == NULL) {
+        printf("Semente da partida: %llu\n", (unsigned long long)semente);
     }
+    printf("\n");
     
-    // Solicitar quantidade de territórios
-    do {
-        printf("\nQuantos territórios deseja cadastrar? (mínimo %d): ", numJogadores);
-        scanf("%d", &quantidadeTeritorios);
-        if (quantidadeTeritorios < numJogadores) {
-            printf("Erro: Deve haver pelo menos 1 território por jogador!\n");
+    if (arquivoCarregado != NULL) {
+        // Retomar uma partida salva
+        if (!carregarSnapshot(jogo, arquivoCarregado)) {
+            printf("Erro: Não foi possível carregar o jogo salvo em '%s'!\n", arquivoCarregado);
+            return 1;
         }
-    } while (quantidadeTeritorios < numJogadores);
-    
-    // Alocar memória dinamicamente para territórios
-    mapa = alocarTeritorios(quantidadeTeritorios);
-    
-    printf("\n=== FASE DE CADASTRO DOS TERRITÓRIOS ===\n");
-    printf("Você irá cadastrar %d territórios.\n", quantidadeTeritorios);
-    
-    // Cadastrar territórios
-    for (int i = 0; i < quantidadeTeritorios; i++) {
-        cadastrarTerritorio(&mapa[i], i);
+        printf("Jogo carregado de '%s' (%d jogadores, %d territórios).\n", 
+               arquivoCarregado, jogo->numJogadores, jogo->mapa.quantidade);
+        registrarMissoesLog(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+    } else {
+        cadastrarPartida(jogo);
     }
     
+    // Cada alteração do mapa durante o jogo vai para o diário (desfazer/refazer)
+    DiarioJogadas diario;
+    memset(&diario, 0, sizeof(diario));
+    jogo->mapa.diario = &diario;
+    
     printf("\n=== INÍCIO DO JOGO ===\n");
     printf("Todos os jogadores e territórios foram cadastrados!\n");
     printf("Consulte suas missões estratégicas para vencer!\n");
@@ -474,43 +6957,93 @@ int main() {
         printf("2. Exibir missões dos jogadores\n");
         printf("3. Realizar ataque\n");
         printf("4. Verificar condições de vitória\n");
-        printf("5. Sair do jogo\n");
+        printf("5. Salvar jogo\n");
+        printf("6. Exibir mapa com filtros e paginação\n");
+        printf("7. Desfazer último ataque\n");
+        printf("8. Refazer ataque desfeito\n");
+        printf("9. Ataque relâmpago (repete até conquistar)\n");
+        printf("0. Sair do jogo\n");
         printf("Escolha uma opção: ");
         scanf("%d", &opcao);
         
         switch (opcao) {
             case 1:
-                exibirTodosTeritorios(mapa, quantidadeTeritorios);
+                exibirTodosTeritorios(&jogo->mapa);
                 break;
                 
             case 2:
                 printf("\n=== MISSÕES ESTRATÉGICAS ===\n");
-                for (int i = 0; i < numJogadores; i++) {
-                    exibirMissao(jogadores[i].missao, jogadores[i].nome);
+                for (int i = 0; i < jogo->numJogadores; i++) {
+                    exibirMissao(&jogo->jogadores[i].missao, jogo->jogadores[i].nome);
                 }
                 break;
                 
             case 3:
-                selecionarEAtacar(mapa, quantidadeTeritorios);
+                selecionarEAtacar(&jogo->mapa, &jogo->gerador);
                 // Verificar se alguém venceu após o ataque
-                vencedor = verificarVencedor(jogadores, numJogadores, mapa, quantidadeTeritorios);
+                vencedor = verificarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
                 if (vencedor >= 0) {
-                    opcao = 5; // Encerrar jogo
+                    opcao = 0; // Encerrar jogo
                 }
                 break;
                 
             case 4:
                 printf("\n=== VERIFICAÇÃO DE MISSÕES ===\n");
-                vencedor = verificarVencedor(jogadores, numJogadores, mapa, quantidadeTeritorios);
+                vencedor = verificarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
                 if (vencedor < 0) {
                     printf("Nenhum jogador completou sua missão ainda.\n");
                     printf("Continue jogando para alcançar seus objetivos!\n");
                 } else {
-                    opcao = 5; // Encerrar jogo
+                    opcao = 0; // Encerrar jogo
+                }
+                break;
+                
+            case 5: {
+                char caminho[256];
+                printf("Nome do arquivo para salvar: ");
+                scanf(" %255s", caminho);
+                if (salvarSnapshot(jogo, caminho)) {
+                    printf("Jogo salvo em '%s'. Para retomar: war --carregar %s\n", caminho, caminho);
+                } else {
+                    printf("Erro: Não foi possível salvar o jogo em '%s'!\n", caminho);
+                }
+                break;
+            }
+                
+            case 6:
+                exibirMapaFiltrado(&jogo->mapa);
+                break;
+                
+            case 7: {
+                int desfeitas = desfazerJogada(&jogo->mapa);
+                if (desfeitas > 0) {
+                    printf("Último ataque desfeito (%d alterações revertidas).\n", desfeitas);
+                } else {
+                    printf("Não há ataques para desfazer.\n");
+                }
+                break;
+            }
+                
+            case 8: {
+                int refeitas = refazerJogada(&jogo->mapa);
+                if (refeitas > 0) {
+                    printf("Ataque refeito (%d alterações reaplicadas).\n", refeitas);
+                } else {
+                    printf("Não há ataques desfeitos para refazer.\n");
+                }
+                break;
+            }
+                
+            case 9:
+                selecionarEAtacarBlitz(&jogo->mapa, &jogo->gerador);
+                // Uma única verificação de vitória no fim de todas as rodadas
+                vencedor = verificarVencedor(jogo->jogadores, jogo->numJogadores, &jogo->mapa);
+                if (vencedor >= 0) {
+                    opcao = 0; // Encerrar jogo
                 }
                 break;
                 
-            case 5:
+            case 0:
                 printf("\nEncerrando o jogo...\n");
                 break;
                 
@@ -518,28 +7051,34 @@ int main() {
                 printf("Opção inválida! Tente novamente.\n");
         }
         
-        if (opcao != 5 && vencedor < 0) {
+        if (opcao != 0 && vencedor < 0) {
             printf("\nPressione Enter para continuar...");
             getchar(); // Limpar buffer
             getchar(); // Aguardar Enter
         }
         
-    } while (opcao != 5 && vencedor < 0);
+    } while (opcao != 0 && vencedor < 0);
     
     // Exibir resultado final
+    jogo->vencedor = vencedor;
+    registrarFimLog(jogo);
     if (vencedor >= 0) {
         printf("\n=== RESULTADO FINAL ===\n");
         printf("🏆 PARABÉNS! O vencedor é: %s (%s)\n", 
-               jogadores[vencedor].nome, jogadores[vencedor].cor);
-        printf("Missão cumprida: \"%s\"\n", jogadores[vencedor].missao);
+               jogo->jogadores[vencedor].nome, nomeCor(&jogo->mapa.cores, jogo->jogadores[vencedor].cor));
+        char texto[128];
+        descreverMissao(&jogo->jogadores[vencedor].missao, texto, sizeof(texto));
+        printf("Missão cumprida: \"%s\"\n", texto);
     }
     
     // Exibir mapa final
     printf("\n=== MAPA FINAL DOS TERRITÓRIOS ===\n");
-    exibirTodosTeritorios(mapa, quantidadeTeritorios);
+    exibirTodosTeritorios(&jogo->mapa);
     
     // Liberar memória alocada
-    liberarMemoria(mapa, jogadores, numJogadores);
+    liberarMemoria(&jogo->mapa, jogo->jogadores, jogo->numJogadores);
+    destruirArena(&arena);
+    free(diario.registros);
     
     printf("\nObrigado por jogar WAR Estruturado - Nível Mestre!\n");
     return 0;